@@ -34,6 +34,17 @@ enum aga_config_node_type {
 
 typedef asys_native_long_t aga_config_int_t;
 
+/*
+ * All of a tree's nodes, children arrays and strings live in blocks chained
+ * Off its root, so the whole tree goes in one `aga_config_delete'.
+ */
+struct aga_config_block {
+	struct aga_config_block* next;
+
+	asys_size_t size;
+	asys_size_t used;
+};
+
 struct aga_config_node;
 struct aga_config_node {
 	char* name;
@@ -43,19 +54,90 @@ struct aga_config_node {
 		char* string;
 		aga_config_int_t integer;
 		double flt;
+
+		struct aga_config_block* arena; /* Only used by the root node. */
 	} data;
 
 	asys_size_t scratch;
 
 	struct aga_config_node* children;
 	asys_size_t len;
+
+	/*
+	 * A hash table of child indices (plus one) for nodes with many children
+	 * -- see `aga_config_lookup_raw'. Null for smaller nodes.
+	 */
+	asys_uint_t* index;
+};
+
+/*
+ * Configs are compiled into this form by `aga_build' -- the header, then the
+ * Nodes in breadth-first order (so each node's children are contiguous) with
+ * The tree root first, then child index tables, then a string table.
+ * Integers are stored as doubles and so are exact to 2^53.
+ */
+#define AGA_CONFIG_BINARY_MAGIC ("\0AGC")
+
+struct aga_config_binary_header {
+	char magic[4];
+
+	asys_uint_t count;
+	asys_uint_t index_size; /* In `asys_uint_t's. */
+	asys_uint_t strings_size;
+};
+
+struct aga_config_binary_node {
+	/* Offsets into the string table plus one -- zero for none. */
+	asys_uint_t name;
+	asys_uint_t string;
+
+	asys_uint_t type;
+	asys_uint_t children; /* Index of the first child. */
+	asys_uint_t len;
+	asys_uint_t index; /* Offset into the index tables plus one. */
+
+	double value;
+};
+
+/* A single path to resolve as part of `aga_config_lookup_all'. */
+struct aga_config_query {
+	const char** names;
+	asys_size_t count;
+
+	/* As with `aga_config_lookup' -- `value' may be null to only get `node'. */
+	enum aga_config_node_type type;
+	void* value;
+
+	struct aga_config_node* node;
+	enum asys_result result;
 };
 
 enum asys_result aga_config_new(
 		struct asys_stream*, asys_size_t, struct aga_config_node*);
 
+/*
+ * Parses config text which is already resident in memory, or loads a
+ * Compiled config.
+ */
+enum asys_result aga_config_new_memory(
+		const void*, asys_size_t, struct aga_config_node*);
+
+/*
+ * As with `aga_config_new_memory' except that compiled configs are loaded
+ * In-place -- names and strings point into the data, which must outlive the
+ * Tree and not be written to.
+ */
+enum asys_result aga_config_view(
+		const void*, asys_size_t, struct aga_config_node*);
+
 enum asys_result aga_config_delete(struct aga_config_node*);
 
+/*
+ * Copies a string into the tree under `root' -- i.e. for replacing string
+ * Values, which must not be freed individually.
+ */
+char* aga_config_string(struct aga_config_node*, const char*);
+
 /*
  * NOTE: `aga_config_variable' and callers (all lookup functions) output a
  *		 Heap allocated string for `type == AGA_PATH'. This may change once
@@ -79,6 +161,19 @@ enum asys_result aga_config_lookup(
 		struct aga_config_node*, const char**, asys_size_t, void*,
 		enum aga_config_node_type, asys_bool_t);
 
+/*
+ * Resolves a batch of queries against the same tree, with each query
+ * Yielding its own `result'. Consecutive queries which only differ by their
+ * Last name (i.e. `Position/X', `Position/Y') share the walk to their parent
+ * So should be kept together.
+ */
+enum asys_result aga_config_lookup_all(
+		struct aga_config_node*, struct aga_config_query*, asys_size_t);
+
 enum asys_result aga_config_dump(struct aga_config_node*, struct asys_stream*);
 
+/* NOTE: Only available in dev builds. */
+enum asys_result aga_config_compile(
+		struct aga_config_node*, struct asys_stream*);
+
 #endif
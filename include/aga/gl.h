@@ -34,4 +34,20 @@
 # undef GL_GLEXT_PROTOTYPES
 #endif
 
+/*
+ * Packed pixel types are GL 1.2 and so are missing from some 1.1 headers --
+ * Check for them at runtime before use.
+ */
+#ifndef GL_UNSIGNED_SHORT_4_4_4_4
+# define GL_UNSIGNED_SHORT_4_4_4_4 (0x8033)
+#endif
+
+#ifndef GL_UNSIGNED_SHORT_5_5_5_1
+# define GL_UNSIGNED_SHORT_5_5_5_1 (0x8034)
+#endif
+
+#ifndef GL_UNSIGNED_SHORT_5_6_5
+# define GL_UNSIGNED_SHORT_5_6_5 (0x8363)
+#endif
+
 #endif
@@ -0,0 +1,52 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#ifndef AGA_LZ_H
+#define AGA_LZ_H
+
+#include <asys/base.h>
+#include <asys/result.h>
+
+/*
+ * A small LZSS codec for pack entries. Data is a sequence of groups, each a
+ * Flag byte followed by up to eight items -- a set flag bit (LSB first) marks
+ * A literal byte and a clear one marks a two byte back-reference holding a
+ * 12-bit distance and a 4-bit length.
+ */
+#define AGA_LZ_WINDOW (4096)
+#define AGA_LZ_MIN_MATCH (3)
+#define AGA_LZ_MAX_MATCH (AGA_LZ_MIN_MATCH + 15)
+
+/* Decoder state -- allows output to be produced incrementally. */
+struct aga_lz {
+	asys_uchar_t window[AGA_LZ_WINDOW];
+	asys_size_t head;
+
+	asys_uint_t flags;
+
+	/* Any back-reference left over from the last call. */
+	asys_size_t match;
+	asys_size_t remaining;
+};
+
+void aga_lz_begin(struct aga_lz*);
+
+/*
+ * Decodes from `*in' into the output buffer until either it is full or the
+ * Input runs dry, advancing `*in' and `*in_count' past whatever was used.
+ * Items are only consumed once all of their input is available. Returns the
+ * Number of bytes written.
+ */
+asys_size_t aga_lz_decode(
+		struct aga_lz*, const asys_uchar_t**, asys_size_t*, void*,
+		asys_size_t);
+
+/*
+ * NOTE: Encoding is only available in dev builds. The output buffer is
+ * 		 Allocated and must be freed by the caller.
+ */
+enum asys_result aga_lz_encode(const void*, asys_size_t, void**, asys_size_t*);
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#ifndef AGA_MESH_H
+#define AGA_MESH_H
+
+#include <asys/base.h>
+#include <asys/result.h>
+
+/*
+ * Index buffer processing for built models. Everything here works on
+ * Triangle lists of `count' indices into `vertices' vertices -- `count' must
+ * Be a multiple of three.
+ */
+
+/* The size of the LRU cache modelled when ordering triangles. */
+#define AGA_MESH_CACHE (32)
+
+/* The size of the FIFO cache modelled when measuring ACMR. */
+#define AGA_MESH_FIFO (16)
+
+/*
+ * Reorders triangles in-place for post-transform vertex cache locality --
+ * This is Forsyth's "Linear-Speed Vertex Cache Optimisation".
+ */
+enum asys_result aga_mesh_order(asys_uint_t*, asys_size_t, asys_size_t);
+
+/*
+ * Reorders vertices of `size' bytes each into the order they are first used
+ * By the indices, which are rewritten to match. Unused vertices are dropped
+ * And the new vertex count is written out.
+ */
+enum asys_result aga_mesh_fetch(
+		asys_uint_t*, asys_size_t, void*, asys_size_t, asys_size_t,
+		asys_size_t*);
+
+/*
+ * The average cache miss ratio -- the number of vertex transforms per
+ * Triangle when run through a FIFO cache of the given size.
+ */
+enum asys_result aga_mesh_acmr(
+		const asys_uint_t*, asys_size_t, asys_size_t, asys_size_t, float*);
+
+/*
+ * Converts a triangle list into a single triangle strip, joining runs with
+ * Degenerate triangles. Triangles are taken in list order as far as possible
+ * So as to keep the cache behaviour of `aga_mesh_order'. The strip is
+ * Allocated and must be freed by the caller.
+ */
+enum asys_result aga_mesh_strip(
+		const asys_uint_t*, asys_size_t, asys_size_t, asys_uint_t**,
+		asys_size_t*);
+
+#endif
@@ -7,22 +7,75 @@
 #define AGA_PACK_H
 
 #include <aga/config.h>
+#include <aga/lz.h>
 #include <asys/result.h>
 
 #include <asys/stream.h>
+#include <asys/thread.h>
 
+/*
+ * Packs begin with a header followed by `header.size' bytes of directory and
+ * Then the resource data itself. Packs built before the binary directory was
+ * Introduced carry an SGML directory instead -- these are still loaded but
+ * Incur a full parse on startup.
+ */
 #define AGA_PACK_MAGIC (0xA6AU)
+#define AGA_PACK_BINARY_MAGIC (0xA6BU)
+
+/*
+ * The directory is padded so that resource data starts on this boundary and
+ * Each entry's data is padded out to it, so that mapped data can be used
+ * In-place as typed data.
+ */
+#define AGA_PACK_ALIGN (8)
+#define AGA_PACK_ALIGNED(n) \
+	(((n) + (AGA_PACK_ALIGN - 1)) & ~((asys_size_t) (AGA_PACK_ALIGN - 1)))
+
+/* The entry's stored data is LZ compressed -- see `aga/lz.h'. */
+#define AGA_RESOURCE_COMPRESSED (1U << 0)
+
+/*
+ * The entry holds a compiled config (see `aga_config_compile') in place of
+ * The SGML file it is named after.
+ */
+#define AGA_RESOURCE_CONFIG (1U << 1)
+
+#define AGA_RESOURCE_READER_BUFFER (4096)
+
+/* The stride at which prefetches fault in mapped resource data. */
+#define AGA_RESOURCE_PAGE (4096)
 
 struct aga_resource_pack;
 
 typedef float aga_model_tail_t[6];
 typedef asys_uint_t aga_image_tail_t;
 
+enum aga_resource_prefetch {
+	AGA_PREFETCH_NONE,
+	AGA_PREFETCH_QUEUED,
+	AGA_PREFETCH_LOADING
+};
+
 struct aga_resource_pack_header {
 	asys_uint_t size;
 	asys_uint_t magic;
 };
 
+/*
+ * The binary directory is a `asys_uint_t' entry count, followed by that many
+ * Entries and finally a table of nul-terminated names.
+ */
+struct aga_resource_pack_entry {
+	asys_uint_t name; /* Offset into the directory's string table. */
+	asys_uint_t offset;
+	asys_uint_t size; /* The size of the data once decompressed. */
+	asys_uint_t stored; /* The size of the data as it lies in the pack. */
+	asys_uint_t flags;
+	asys_uint_t version; /* Zero if the resource kind is unversioned. */
+	aga_image_tail_t width; /* Zero if the resource is not an image. */
+	aga_model_tail_t extent; /* Zeroed if the resource is not a model. */
+};
+
 struct aga_resource {
 	asys_size_t refcount;
 	/*
@@ -35,30 +88,125 @@ struct aga_resource {
 	void* data;
 	asys_size_t size;
 
+	asys_size_t stored;
+	asys_uint_t flags;
+
 	struct aga_resource_pack* pack;
 
-	struct aga_config_node* config;
+	/* Links in the pack's LRU list while unreferenced but still resident. */
+	struct aga_resource* lru_prev;
+	struct aga_resource* lru_next;
+
+	/* Links in the pack's prefetch queue -- see `aga_resource_prefetch'. */
+	struct aga_resource* prefetch_next;
+	enum aga_resource_prefetch prefetch;
+
+	/* Points into the pack's directory -- see `aga_resource_pack_entry'. */
+	const char* name;
+	asys_uint_t version;
+	aga_image_tail_t width;
+	aga_model_tail_t extent;
+
+#ifdef AGA_DEVBUILD
+	asys_bool_t traced; /* Whether its first use has been traced yet. */
+#endif
 };
 
 struct aga_resource_pack {
 	struct asys_stream stream;
 	asys_size_t data_offset;
 
+	struct aga_resource* resources;
+	asys_size_t count;
+
 	/*
-	 * TODO: This should eventually be a hashmap. Windows has `GetAtom' etc. as
-	 * 		 As a sort of built-in hashmap system -- does X allow arbitrary use
-	 * 		 Of Atoms (and is it wise to do so?). If so, then add natively to
-	 * 		 Python to avoid re-creating loads of strings.
+	 * Heap storage backing resource names where the directory could not be
+	 * Used in-place from the mapping.
 	 */
-	struct aga_resource* resources;
-	asys_size_t count; /* Alias for `pack->root.children->len'. */
+	void* directory;
+
+	/*
+	 * Open-addressed hash index over resource names, built once on pack load.
+	 * Slots hold an index into `resources' plus one -- zero marks an empty
+	 * Slot. `index_size' is always a power of two.
+	 */
+	/*
+	 * TODO: Windows has `GetAtom' etc. as a sort of built-in hashmap
+	 * 		 System -- does X allow arbitrary use of Atoms (and is it wise to
+	 * 		 Do so?). If so, then add natively to Python to avoid re-creating
+	 * 		 Loads of strings.
+	 */
+	asys_size_t* index;
+	asys_size_t index_size;
+
+	/*
+	 * The whole pack file if it could be mapped on load, in which case
+	 * Resource data points straight into the mapping rather than into
+	 * Per-resource heap copies. Null where mapping is unavailable.
+	 */
+	void* map;
+	asys_size_t map_size;
+
+	/*
+	 * Released resources keep their data until the heap memory held by the
+	 * Pack exceeds `budget', at which point sweeps evict from the head of
+	 * The LRU list -- i.e. the least recently released first.
+	 */
+	struct aga_resource* lru_head;
+	struct aga_resource* lru_tail;
+	asys_size_t resident;
+	asys_size_t budget;
+
+	/*
+	 * Prefetches are serviced by a worker thread with its own stream onto
+	 * The pack file, as positional reads are emulated with seeks on some
+	 * Platforms. While it runs, `lock' guards resource data, refcounts,
+	 * The LRU list and the prefetch queue -- `queued' wakes the worker and
+	 * `loaded' is signalled as each prefetch completes. Where threads are
+	 * Unavailable `threaded' is false and prefetches load inline.
+	 */
+	asys_bool_t threaded;
+	asys_bool_t quit;
+
+	struct asys_thread prefetcher;
+	struct asys_stream prefetch_stream;
+	struct asys_mutex lock;
+	struct asys_condition queued;
+	struct asys_condition loaded;
+
+	struct aga_resource* prefetch_head;
+	struct aga_resource* prefetch_tail;
+	asys_size_t pending;
 
 	/* TODO: This should be enabled for dev builds, not just debug builds. */
 #ifndef NDEBUG
 	asys_size_t outstanding_refs;
 #endif
 
-	struct aga_config_node root;
+#ifdef AGA_DEVBUILD
+	asys_bool_t tracing;
+	struct asys_stream trace;
+	asys_size_t trace_start;
+#endif
+};
+
+/*
+ * Reads resource data sequentially, decompressing as it goes where the entry
+ * Is compressed. Unlike `aga_resource_seek' this works for any entry.
+ */
+struct aga_resource_reader {
+	struct aga_resource* resource;
+	struct asys_stream* stream; /* Where stored data is read when unmapped. */
+
+	asys_size_t position; /* Bytes of resource data produced so far. */
+	asys_size_t fetched; /* Bytes of stored data taken from the pack. */
+
+	/* Staging for stored data where the pack is not mapped. */
+	asys_uchar_t buffer[AGA_RESOURCE_READER_BUFFER];
+	asys_size_t buffer_start;
+	asys_size_t buffer_end;
+
+	struct aga_lz lz;
 };
 
 /*
@@ -71,21 +219,69 @@ extern struct aga_resource_pack* aga_global_pack;
 enum asys_result aga_resource_pack_new(const char*, struct aga_resource_pack*);
 enum asys_result aga_resource_pack_delete(struct aga_resource_pack*);
 
+/* The hash used to index resource names -- see `aga_resource_pack'. */
+asys_size_t aga_resource_pack_hash(const char*);
+
 enum asys_result aga_resource_pack_lookup(
 		struct aga_resource_pack*, const char*, struct aga_resource**);
 
+/*
+ * Records the first use of each resource from here on -- in order, with its
+ * Size and the microseconds since tracing began -- as an SGML document which
+ * `aga_build' can take as a project's `Trace' to lay out pack data by. The
+ * Trace is completed when the pack is deleted.
+ * NOTE: Tracing is only available in dev builds.
+ */
+enum asys_result aga_resource_pack_trace(
+		struct aga_resource_pack*, const char*);
+
+/* Evicts released resources until the pack is back within its budget. */
 enum asys_result aga_resource_pack_sweep(struct aga_resource_pack*);
 
+/* Yields the number of prefetches yet to complete. */
+enum asys_result aga_resource_pack_pending(
+		struct aga_resource_pack*, asys_size_t*);
+
 /* Also counts as an acquire - i.e. initial refcount is 1. */
 enum asys_result aga_resource_new(
 		struct aga_resource_pack*, const char*, struct aga_resource**);
 
+/*
+ * Queues a resource to be loaded in the background so that a later
+ * `aga_resource_new' finds it already resident. Prefetched data is held as if
+ * It had been released, so counts against the pack budget and can be evicted
+ * By a sweep before it is used.
+ */
+enum asys_result aga_resource_prefetch(struct aga_resource_pack*, const char*);
+
 enum asys_result aga_resource_stream(
 		struct aga_resource_pack*, const char*, struct asys_stream**,
 		asys_size_t*);
 
+/*
+ * NOTE: The pack stream holds the data as it is stored -- compressed entries
+ * 		 Cannot be sought and need to go through a reader instead.
+ * NOTE: This moves the cursor shared by all users of the pack stream so is
+ * 		 Only for consumers which need a sequential stream (i.e. the config
+ * 		 And script parsers). Prefer readers or `aga_resource_read_at'.
+ */
 enum asys_result aga_resource_seek(struct aga_resource*, struct asys_stream**);
 
+/*
+ * Reads resource data from an offset without any shared stream position --
+ * Compressed entries must be resident. Yields `ASYS_RESULT_EOF' on a short
+ * Read at the end of the resource.
+ */
+enum asys_result aga_resource_read_at(
+		struct aga_resource*, asys_size_t, void*, asys_size_t, asys_size_t*);
+
+enum asys_result aga_resource_reader_new(
+		struct aga_resource*, struct aga_resource_reader*);
+
+/* Yields `ASYS_RESULT_EOF' on a short read at the end of the resource. */
+enum asys_result aga_resource_read(
+		struct aga_resource_reader*, void*, asys_size_t, asys_size_t*);
+
 /*
  * NOTE: You should ensure that you acquire after any potential error
  * 		 Conditions during object init, and before any potential error
@@ -17,6 +17,8 @@ struct aga_settings {
 #ifdef AGA_DEVBUILD
 	asys_bool_t compile;
 	const char* build_file;
+
+	const char* trace_file;
 #endif
 
 	const char* title;
@@ -27,6 +29,7 @@ struct aga_settings {
 	const char* version;
 
 	const char* respack;
+	asys_size_t resource_budget;
 
 	asys_size_t audio_buffer;
 	asys_bool_t audio_enabled;
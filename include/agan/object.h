@@ -22,6 +22,82 @@ struct aga_vertex {
 	float pos[3];
 };
 
+/*
+ * Version 3 models are indexed. Their data is an `aga_model_header' followed
+ * By its vertices and then its indices, which are 16-bit wherever the vertex
+ * Count allows and 32-bit otherwise. Vertex colouration is not stored.
+ */
+#define AGA_MODEL_INDEXED (3)
+
+/* The indices form a single triangle strip rather than a triangle list. */
+#define AGA_MODEL_STRIP (1 << 0)
+
+/* Vertices are stored as `aga_model_packed_vertex' -- see below. */
+#define AGA_MODEL_QUANTISED (1 << 1)
+
+/* Vertex data is padded out to this to keep the indices after it aligned. */
+#define AGA_MODEL_ALIGN(size) (((size) + 3) & ~((asys_size_t) 3))
+
+struct aga_model_header {
+	asys_uint_t vertices;
+	asys_uint_t indices;
+	asys_uint_t index_size;
+	asys_uint_t flags;
+
+	/*
+	 * For quantised models -- UV and then position components are recovered
+	 * As `bias + scale * n'.
+	 */
+	float scale[5];
+	float bias[5];
+};
+
+struct aga_model_vertex {
+	float uv[2];
+	float norm[3];
+	float pos[3];
+};
+
+/*
+ * Normals are as GL's signed byte normals -- a component `c' is taken to be
+ * `(2c + 1) / 255'.
+ */
+struct aga_model_packed_vertex {
+	unsigned short uv[2];
+	unsigned short pos[3];
+	signed char norm[3];
+	signed char pad;
+};
+
+/*
+ * Version 1 images carry a full mip chain. Their data is an
+ * `aga_image_header' followed by each level from the largest down to 1x1,
+ * Halving each side until it reaches one. Sides are powers of two and texels
+ * Are tightly packed in the header's `aga_image_format'.
+ */
+#define AGA_IMAGE_MIPMAPPED (1)
+
+/*
+ * The 16-bit formats are stored as native `unsigned short's laid out as GL's
+ * Packed pixel types and are only produced for inputs with `Quantise' set.
+ */
+enum aga_image_format {
+	AGA_IMAGE_RGBA,
+	AGA_IMAGE_RGB,
+	AGA_IMAGE_LUMINANCE,
+	AGA_IMAGE_LUMINANCE_ALPHA,
+	AGA_IMAGE_RGBA4,
+	AGA_IMAGE_RGB5_A1,
+	AGA_IMAGE_R5_G6_B5
+};
+
+struct aga_image_header {
+	asys_uint_t width;
+	asys_uint_t height;
+	asys_uint_t levels;
+	asys_uint_t format; /* An `aga_image_format'. */
+};
+
 struct agan_lightdata {
 	float ambient[4];
 	float diffuse[4];
@@ -42,28 +118,64 @@ struct agan_lightdata {
 };
 
 /*
- * TODO: Central object/light registry and distribute handles. Spatializing
- * 		 This makes it easier to do streaming/chunking and means we can ensure
- * 		 Sequential reads -- which is super important if we want to run off CD
- * 		 Media. Maybe add a separate file type in packs which represent
- * 		 Contiguous interleaved objects to avoid needing to seek over
- * 		 Intermediate structures or rely on pack ordering at an application
- * 		 Maintainer level.
+ * Objects live in a central registry and are handed out to script land as
+ * Small handles. The low bits of a handle index the object's slot and the
+ * High bits are the slot's generation, which is bumped each time the slot is
+ * Reused so that stale handles are caught rather than reaching a new object.
  */
+typedef asys_uint_t agan_object_handle_t;
+
+#define AGAN_OBJECT_INDEX_BITS (20)
+#define AGAN_OBJECT_INDEX_MASK ((1 << AGAN_OBJECT_INDEX_BITS) - 1)
+#define AGAN_OBJECT_GENERATIONS (1 << (32 - AGAN_OBJECT_INDEX_BITS))
+
+/*
+ * TODO: Central light registry. Spatializing the object registry makes it
+ * 		 Easier to do streaming/chunking and means we can ensure sequential
+ * 		 Reads -- which is super important if we want to run off CD media.
+ * 		 Maybe add a separate file type in packs which represent contiguous
+ * 		 Interleaved objects to avoid needing to seek over intermediate
+ * 		 Structures or rely on pack ordering at an application maintainer
+ * 		 Level.
+ */
+struct agan_model;
+struct agan_texture;
+
 struct agan_object {
 	struct py_object* transform;
 	struct aga_resource* res;
 	struct agan_lightdata* light_data;
-	asys_uint_t ind;
+	asys_uint_t ind; /* The object's slot -- unique among live objects. */
 
 	/* TODO: This only needs to exist in devbuilds. */
 	char* modelpath;
 
-	asys_uint_t drawlist;
+	/* Shared between all objects using the same model or texture. */
+	struct agan_model* model;
+	struct agan_texture* texture;
+
 	float min_extent[3];
 	float max_extent[3];
+
+	/* The object's handle -- or the last one given out if the slot is free. */
+	agan_object_handle_t handle;
+	asys_bool_t live;
+	asys_size_t next_free; /* The next free slot plus one, if free. */
 };
 
+/*
+ * Registry slots are contiguous and can be walked directly for batch work.
+ * Slots which are not `live' are free and must be skipped. Slots may move
+ * When objects are created so pointers into them should not be held.
+ */
+struct agan_object* agan_object_slots(asys_size_t*);
+
+/* Returns null for stale or out of range handles. */
+struct agan_object* agan_object_get(agan_object_handle_t);
+
+/* As above for a script argument -- raising a script error on failure. */
+struct agan_object* agan_object_arg(struct py_object*);
+
 enum asys_result agan_getobjconf(struct agan_object*, struct aga_config_node*);
 
 enum asys_result agan_obj_register(struct py_env*);
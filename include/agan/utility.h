@@ -16,6 +16,12 @@ struct py_object* agan_getconf(
 struct py_object* agan_packlist(
 		struct py_env*, struct py_object*, struct py_object*);
 
+struct py_object* agan_prefetch(
+		struct py_env*, struct py_object*, struct py_object*);
+
+struct py_object* agan_prefetching(
+		struct py_env*, struct py_object*, struct py_object*);
+
 struct py_object* agan_log(
 		struct py_env*, struct py_object*, struct py_object*);
 
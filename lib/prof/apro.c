@@ -71,6 +71,18 @@ void apro_stamp_end(enum apro_section section) {
 #endif
 }
 
+apro_unit_t apro_time_us(void) {
+#ifndef APRO_DISABLE
+	struct apro_timestamp stamp = { 0 };
+
+	aga_getstamp(&stamp);
+
+	return aga_stamp_us(&stamp);
+#else
+	return 0;
+#endif
+}
+
 apro_unit_t apro_stamp_us(enum apro_section section) {
 #ifndef APRO_DISABLE
 	return aga_stamp_us(&aga_global_prof[section * 2 + 1]);
@@ -89,6 +89,9 @@ void apro_stamp_end(enum apro_section);
 apro_unit_t apro_stamp_us(enum apro_section);
 void apro_clear(void);
 
+/* Only meaningful relative to another call -- zero where timing is disabled. */
+apro_unit_t apro_time_us(void);
+
 const char* apro_section_name(enum apro_section);
 
 #endif
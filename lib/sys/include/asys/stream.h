@@ -34,6 +34,15 @@ enum asys_result asys_stream_tell(struct asys_stream*, asys_offset_t*);
 enum asys_result asys_stream_read(
 		struct asys_stream*, asys_size_t*, void*, asys_size_t);
 
+/*
+ * Reads from an absolute offset without disturbing the stream position, so
+ * Concurrent reads on one stream do not interfere. Platforms without
+ * Positional reads emulate this with a seek -- here the stream position is
+ * Clobbered and concurrent use of a stream is not safe.
+ */
+enum asys_result asys_stream_read_at(
+		struct asys_stream*, asys_offset_t, asys_size_t*, void*, asys_size_t);
+
 /* NOTE: Replicates `fgets'-style line reads. */
 enum asys_result asys_stream_read_line(
 		struct asys_stream*, void*, asys_size_t);
@@ -42,6 +51,16 @@ enum asys_result asys_stream_attribute(
 		struct asys_stream*, enum asys_file_attribute_type,
 		union asys_file_attribute*);
 
+/*
+ * Maps the first `count' bytes of the stream into memory. The mapping is
+ * Copy-on-write -- writes through it stay private to the process and never
+ * Reach the file. It remains valid after the stream is deleted and must be
+ * Released with `asys_stream_unmap'. Platforms without file mapping yield
+ * `ASYS_RESULT_NOT_IMPLEMENTED' -- callers are expected to fall back to reads.
+ */
+enum asys_result asys_stream_map(struct asys_stream*, asys_size_t, void**);
+enum asys_result asys_stream_unmap(void*, asys_size_t);
+
 /* NOTE: No stream-writing IO functions are available outside of dev builds. */
 enum asys_result asys_stream_new_write(struct asys_stream*, const char*);
 
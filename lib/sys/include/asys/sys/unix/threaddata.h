@@ -0,0 +1,26 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#ifndef ASYS_UNIX_THREADDATA_H
+#define ASYS_UNIX_THREADDATA_H
+
+#include <pthread.h>
+
+struct asys_thread {
+	pthread_t handle;
+
+	asys_thread_function_t function;
+	void* argument;
+};
+
+struct asys_mutex {
+	pthread_mutex_t handle;
+};
+
+struct asys_condition {
+	pthread_cond_t handle;
+};
+
+#endif
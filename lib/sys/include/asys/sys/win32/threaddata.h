@@ -0,0 +1,25 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#ifndef ASYS_WIN32_THREADDATA_H
+#define ASYS_WIN32_THREADDATA_H
+
+struct asys_thread {
+	void* handle;
+
+	asys_thread_function_t function;
+	void* argument;
+};
+
+/* NOTE: These are kernel mutex and auto-reset event objects respectively. */
+struct asys_mutex {
+	void* handle;
+};
+
+struct asys_condition {
+	void* handle;
+};
+
+#endif
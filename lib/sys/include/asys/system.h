@@ -32,10 +32,12 @@
 
 #ifdef ASYS_UNIX
 # define _POSIX_C_SOURCE 2 /* TODO: We shouldn't rely on this -- remove. */
+# define _XOPEN_SOURCE 500 /* For `pread'. */
 # include <unistd.h>
 # include <fcntl.h>
 # include <sys/stat.h>
 # include <sys/types.h>
+# include <sys/mman.h>
 # include <getopt.h>
 # include <dirent.h>
 #endif
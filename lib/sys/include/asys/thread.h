@@ -0,0 +1,49 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+asys@pm.me>
+ */
+
+#ifndef ASYS_THREAD_H
+#define ASYS_THREAD_H
+
+#include <asys/base.h>
+#include <asys/result.h>
+#include <asys/threaddata.h>
+
+/*
+ * Platforms without threads yield `ASYS_RESULT_NOT_IMPLEMENTED' from all of
+ * These -- callers are expected to fall back to doing the work inline.
+ */
+
+/* NOTE: The thread object must stay in place until it has been joined. */
+enum asys_result asys_thread_new(
+		struct asys_thread*, asys_thread_function_t, void*);
+
+enum asys_result asys_thread_join(struct asys_thread*);
+
+/*
+ * Yields the number of processors available to run threads on -- at least one
+ * Even where threads are unavailable.
+ */
+asys_size_t asys_thread_concurrency(void);
+
+enum asys_result asys_mutex_new(struct asys_mutex*);
+enum asys_result asys_mutex_delete(struct asys_mutex*);
+
+enum asys_result asys_mutex_lock(struct asys_mutex*);
+enum asys_result asys_mutex_unlock(struct asys_mutex*);
+
+enum asys_result asys_condition_new(struct asys_condition*);
+enum asys_result asys_condition_delete(struct asys_condition*);
+
+/*
+ * Waits must be made with the mutex held and may wake spuriously, so should
+ * Always sit in a loop re-checking their predicate. Signals wake at most one
+ * Waiter.
+ */
+enum asys_result asys_condition_wait(
+		struct asys_condition*, struct asys_mutex*);
+
+enum asys_result asys_condition_signal(struct asys_condition*);
+
+#endif
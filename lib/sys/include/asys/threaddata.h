@@ -0,0 +1,33 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+asys@pm.me>
+ */
+
+#ifndef ASYS_THREADDATA_H
+#define ASYS_THREADDATA_H
+
+#include <asys/base.h>
+
+typedef void (*asys_thread_function_t)(void*);
+
+#ifdef ASYS_WIN32
+# include <asys/sys/win32/threaddata.h>
+#elif defined(ASYS_UNIX)
+# include <asys/sys/unix/threaddata.h>
+#else
+/* TODO: Cooperative threading for single-threaded targets? */
+struct asys_thread {
+	asys_thread_function_t function;
+	void* argument;
+};
+
+struct asys_mutex {
+	int handle;
+};
+
+struct asys_condition {
+	int handle;
+};
+#endif
+
+#endif
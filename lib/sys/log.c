@@ -21,7 +21,7 @@
 void asys_log(const char* file, const char* format, ...) {
 #ifdef ASYS_WIN32
 	/* NOTE: This is not ideal but `OutputDebugString' is not great. */
-	static asys_fixed_buffer_t body, buffer;
+	asys_fixed_buffer_t body, buffer;
 	asys_size_t length;
 #endif
 
@@ -71,10 +71,14 @@ void asys_log(const char* file, const char* format, ...) {
 	va_end(list);
 }
 
+/*
+ * NOTE: Result logging may happen from worker threads so formats into a local
+ * 		 Buffer.
+ */
 void asys_log_result(
 		const char* file, const char* function, enum asys_result result) {
 
-	static asys_fixed_buffer_t buffer = { 0 };
+	asys_fixed_buffer_t buffer = { 0 };
 
 	if(!result) return;
 
@@ -87,7 +91,7 @@ void asys_log_result_path(
 		const char* file, const char* function, const char* path,
 		enum asys_result result) {
 
-	static asys_fixed_buffer_t buffer = { 0 };
+	asys_fixed_buffer_t buffer = { 0 };
 
 	if(!result) return;
 
@@ -77,7 +77,7 @@ enum asys_result asys_stream_new_write(
 # elif defined(ASYS_UNIX)
 	stream->fd = 0;
 
-	if((stream->fd = open(path, O_WRONLY | O_CREAT, 0666)) == -1) {
+	if((stream->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666)) == -1) {
 		return asys_result_errno_path(__FILE__, "open", path);
 	}
 
@@ -326,6 +326,27 @@ enum asys_result asys_stream_read(
 #endif
 }
 
+enum asys_result asys_stream_read_at(
+		struct asys_stream* stream, asys_offset_t offset,
+		asys_size_t* read_count, void* buffer, asys_size_t count) {
+
+#ifdef ASYS_UNIX
+	ssize_t result = pread(stream->fd, buffer, count, offset);
+	if(read_count) *read_count = result < 0 ? 0 : (asys_size_t) result;
+
+	if(result == (ssize_t) count) return ASYS_RESULT_OK;
+	else if(result == -1) return asys_result_errno(__FILE__, "pread");
+	else return ASYS_RESULT_EOF;
+#else
+	enum asys_result result;
+
+	result = asys_stream_seek(stream, ASYS_SEEK_SET, offset);
+	if(result) return result;
+
+	return asys_stream_read(stream, read_count, buffer, count);
+#endif
+}
+
 enum asys_result asys_stream_read_line(
 		struct asys_stream* stream, void* buffer, asys_size_t count) {
 
@@ -435,6 +456,79 @@ enum asys_result asys_stream_attribute(
 #endif
 }
 
+enum asys_result asys_stream_map(
+		struct asys_stream* stream, asys_size_t count, void** map) {
+
+#ifdef ASYS_WIN32
+	enum asys_result result;
+
+	HANDLE handle;
+	HANDLE mapping;
+
+	/* NOTE: File mappings are not era-accurate -- see `GetFileSize' above. */
+	handle = (void*) (asys_native_long_t) stream->hfile;
+	mapping = CreateFileMapping(handle, 0, PAGE_WRITECOPY, 0, 0, 0);
+	if(!mapping) {
+		result = ASYS_RESULT_ERROR;
+		asys_log_result(__FILE__, "CreateFileMapping", result);
+		return result;
+	}
+
+	/* The view holds its own reference to the mapping object. */
+	*map = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, count);
+	CloseHandle(mapping);
+
+	if(!*map) {
+		result = ASYS_RESULT_ERROR;
+		asys_log_result(__FILE__, "MapViewOfFile", result);
+		return result;
+	}
+
+	return ASYS_RESULT_OK;
+#elif defined(ASYS_UNIX)
+	void* result;
+
+	result = mmap(
+			0, count, PROT_READ | PROT_WRITE, MAP_PRIVATE, stream->fd, 0);
+	if(result == MAP_FAILED) return asys_result_errno(__FILE__, "mmap");
+
+	*map = result;
+
+	return ASYS_RESULT_OK;
+#else
+	(void) stream;
+	(void) count;
+	(void) map;
+
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_stream_unmap(void* map, asys_size_t count) {
+#ifdef ASYS_WIN32
+	enum asys_result result;
+
+	(void) count;
+
+	if(!UnmapViewOfFile(map)) {
+		result = ASYS_RESULT_ERROR;
+		asys_log_result(__FILE__, "UnmapViewOfFile", result);
+		return result;
+	}
+
+	return ASYS_RESULT_OK;
+#elif defined(ASYS_UNIX)
+	if(munmap(map, count) == -1) return asys_result_errno(__FILE__, "munmap");
+
+	return ASYS_RESULT_OK;
+#else
+	(void) map;
+	(void) count;
+
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
 enum asys_result asys_stream_write(
 		struct asys_stream* stream, const void* buffer, asys_size_t count) {
 
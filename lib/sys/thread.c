@@ -0,0 +1,375 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#include <asys/system.h>
+#include <asys/thread.h>
+#include <asys/error.h>
+#include <asys/log.h>
+
+/*
+ * NOTE: pthreads report errors through their return value rather than
+ * 		 `errno' -- it is set here so that the usual error path can be used.
+ */
+#ifdef ASYS_UNIX
+static enum asys_result asys_thread_error(const char* function, int error) {
+	errno = error;
+	return asys_result_errno(__FILE__, function);
+}
+
+static void* asys_thread_start(void* argument) {
+	struct asys_thread* thread = argument;
+
+	thread->function(thread->argument);
+
+	return 0;
+}
+#endif
+
+#ifdef ASYS_WIN32
+static DWORD WINAPI asys_thread_start(LPVOID argument) {
+	struct asys_thread* thread = argument;
+
+	thread->function(thread->argument);
+
+	return 0;
+}
+#endif
+
+enum asys_result asys_thread_new(
+		struct asys_thread* thread, asys_thread_function_t function,
+		void* argument) {
+
+	if(!thread) return ASYS_RESULT_BAD_PARAM;
+	if(!function) return ASYS_RESULT_BAD_PARAM;
+
+	thread->function = function;
+	thread->argument = argument;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+		DWORD id;
+
+		thread->handle = CreateThread(0, 0, asys_thread_start, thread, 0, &id);
+		if(!thread->handle) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "CreateThread", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_create(&thread->handle, 0, asys_thread_start, thread);
+		if(error) return asys_thread_error("pthread_create", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_thread_join(struct asys_thread* thread) {
+	if(!thread) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		if(WaitForSingleObject(thread->handle, INFINITE) == WAIT_FAILED) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "WaitForSingleObject", result);
+			return result;
+		}
+
+		if(!CloseHandle(thread->handle)) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "CloseHandle", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_join(thread->handle, 0);
+		if(error) return asys_thread_error("pthread_join", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+asys_size_t asys_thread_concurrency(void) {
+#ifdef ASYS_WIN32
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+
+	return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+#elif defined(ASYS_UNIX)
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return count > 0 ? (asys_size_t) count : 1;
+#else
+	return 1;
+#endif
+}
+
+enum asys_result asys_mutex_new(struct asys_mutex* mutex) {
+	if(!mutex) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		if(!(mutex->handle = CreateMutex(0, FALSE, 0))) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "CreateMutex", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_mutex_init(&mutex->handle, 0);
+		if(error) return asys_thread_error("pthread_mutex_init", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_mutex_delete(struct asys_mutex* mutex) {
+	if(!mutex) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		if(!CloseHandle(mutex->handle)) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "CloseHandle", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_mutex_destroy(&mutex->handle);
+		if(error) return asys_thread_error("pthread_mutex_destroy", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_mutex_lock(struct asys_mutex* mutex) {
+	if(!mutex) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		if(WaitForSingleObject(mutex->handle, INFINITE) == WAIT_FAILED) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "WaitForSingleObject", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_mutex_lock(&mutex->handle);
+		if(error) return asys_thread_error("pthread_mutex_lock", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_mutex_unlock(struct asys_mutex* mutex) {
+	if(!mutex) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		if(!ReleaseMutex(mutex->handle)) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "ReleaseMutex", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_mutex_unlock(&mutex->handle);
+		if(error) return asys_thread_error("pthread_mutex_unlock", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_condition_new(struct asys_condition* condition) {
+	if(!condition) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		condition->handle = CreateEvent(0, FALSE, FALSE, 0);
+		if(!condition->handle) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "CreateEvent", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_cond_init(&condition->handle, 0);
+		if(error) return asys_thread_error("pthread_cond_init", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_condition_delete(struct asys_condition* condition) {
+	if(!condition) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		if(!CloseHandle(condition->handle)) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "CloseHandle", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_cond_destroy(&condition->handle);
+		if(error) return asys_thread_error("pthread_cond_destroy", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_condition_wait(
+		struct asys_condition* condition, struct asys_mutex* mutex) {
+
+	if(!condition) return ASYS_RESULT_BAD_PARAM;
+	if(!mutex) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		/*
+		 * An auto-reset event stays signalled until a wait consumes it, so a
+		 * Signal landing between the release and the wait is not lost.
+		 */
+		if((result = asys_mutex_unlock(mutex))) return result;
+
+		if(WaitForSingleObject(condition->handle, INFINITE) == WAIT_FAILED) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "WaitForSingleObject", result);
+		}
+
+		if(result) {
+			asys_log_result(
+					__FILE__, "asys_mutex_lock", asys_mutex_lock(mutex));
+
+			return result;
+		}
+
+		return asys_mutex_lock(mutex);
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_cond_wait(&condition->handle, &mutex->handle);
+		if(error) return asys_thread_error("pthread_cond_wait", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
+
+enum asys_result asys_condition_signal(struct asys_condition* condition) {
+	if(!condition) return ASYS_RESULT_BAD_PARAM;
+
+#ifdef ASYS_WIN32
+	{
+		enum asys_result result;
+
+		if(!SetEvent(condition->handle)) {
+			result = ASYS_RESULT_ERROR;
+			asys_log_result(__FILE__, "SetEvent", result);
+			return result;
+		}
+
+		return ASYS_RESULT_OK;
+	}
+#elif defined(ASYS_UNIX)
+	{
+		int error;
+
+		error = pthread_cond_signal(&condition->handle);
+		if(error) return asys_thread_error("pthread_cond_signal", error);
+
+		return ASYS_RESULT_OK;
+	}
+#else
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
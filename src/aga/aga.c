@@ -115,6 +115,13 @@ enum asys_result asys_main(struct asys_main_data* main_data) {
 	result = aga_resource_pack_new(opts.respack, &pack);
 	asys_log_result(__FILE__, "aga_resource_pack_new", result);
 
+#ifdef AGA_DEVBUILD
+	if(opts.trace_file) {
+		result = aga_resource_pack_trace(&pack, opts.trace_file);
+		asys_log_result(__FILE__, "aga_resource_pack_trace", result);
+	}
+#endif
+
 	/*
 	 * TODO: Trace each resource load (from `pack.c' not here) in verbose mode.
 	 */
@@ -122,7 +129,7 @@ enum asys_result asys_main(struct asys_main_data* main_data) {
 		asys_size_t i;
 
 		for(i = 0; i < pack.count; ++i) {
-			const char* name = pack.resources[i].config->name;
+			const char* name = pack.resources[i].name;
 
 			asys_log(__FILE__, "%s", name);
 		}
@@ -134,6 +141,8 @@ enum asys_result asys_main(struct asys_main_data* main_data) {
 	result = aga_settings_parse_config(&opts, &pack);
 	asys_log_result(__FILE__, "aga_settings_parse_config", result);
 
+	pack.budget = opts.resource_budget;
+
 	asys_log(__FILE__, "Initializing systems...");
 
 	result = aga_window_device_new(&env, opts.display);
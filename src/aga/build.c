@@ -7,8 +7,10 @@
 
 #define AGA_PY_TAIL ("\n\xFF")
 
-/* TODO: Pass this through properly to `aga_build_X'. */
-#define AGA_BUILD_FNAME ("<build>")
+#define AGA_BUILD_CACHE_DEFAULT ("agabuild.cache")
+#define AGA_BUILD_HASH_BLOCK (4096)
+
+#define AGA_BUILD_UNTRACED ((asys_size_t) -1)
 
 #ifdef AGA_DEVBUILD
 # include <glm.h>
@@ -17,12 +19,14 @@
 # include <aga/build.h>
 # include <aga/startup.h>
 # include <aga/pack.h>
+# include <aga/mesh.h>
 
 # include <asys/log.h>
 # include <asys/stream.h>
 # include <asys/file.h>
 # include <asys/memory.h>
 # include <asys/string.h>
+# include <asys/thread.h>
 
 /* TODO: For `struct vertex' definition -- move elsewhere. */
 # include <agan/object.h>
@@ -34,27 +38,98 @@ enum aga_file_kind {
 
 	AGA_KIND_TIFF,
 	AGA_KIND_OBJ,
-	/*
-	 * TODO: We can precompile a more efficiently serialised conftree in
-	 * 		 Non-Debug/Dev builds.
-	 */
 	AGA_KIND_SGML,
 	AGA_KIND_PY,
 	AGA_KIND_WAV,
 	AGA_KIND_MIDI
 };
 
-struct aga_build_conf_pass {
-	struct asys_stream* stream;
+/*
+ * What an artefact was built from -- the input's content and the converter
+ * Which produced it.
+ */
+struct aga_build_stamp {
+	asys_uint_t hash;
+	asys_size_t size;
+	asys_uint_t key;
+};
+
+/*
+ * A single input file as found by the input walk -- this is all the later
+ * Passes know about it.
+ */
+struct aga_build_job {
+	char* path;
+	enum aga_file_kind kind;
+	asys_bool_t compress;
+	asys_bool_t strip;
+	asys_bool_t quantise;
+	enum asys_result result;
+
+	/* `previous' is only meaningful if the cache knew of this input. */
+	asys_bool_t known;
+	struct aga_build_stamp previous;
+	struct aga_build_stamp current;
+};
+
+/*
+ * Inputs are gathered up front and then converted by a pool of workers --
+ * Results are kept per-job so they can be reported in input order however
+ * The work ends up being scheduled.
+ */
+struct aga_build_input_pass {
 	enum aga_file_kind kind;
+	asys_bool_t compress;
+	asys_bool_t strip;
+	asys_bool_t quantise;
+
+	struct aga_build_job* jobs;
+	asys_size_t count;
+
+	/* The next job to be taken -- guarded by `lock' when threaded. */
+	asys_size_t next;
+	struct asys_mutex lock;
+	asys_bool_t threaded;
+
+	/*
+	 * Held over SGML inputs when threaded -- our parser state is per-call
+	 * But libwww's SGML parser has yet to be audited for shared state of its
+	 * Own, so configs are still parsed one at a time.
+	 */
+	struct asys_mutex parse;
+
+	/* The manifest from the last build, if there was one. */
+	struct aga_config_node cache;
+	struct aga_config_node* cached;
+	asys_bool_t* seen;
+};
+
+struct aga_build_conf_pass {
 	asys_size_t offset;
+
+	/* The binary pack directory as it is accumulated. */
+	struct aga_resource_pack_entry* entries;
+	asys_size_t count;
+	char* strings;
+	asys_size_t strings_size;
+};
+
+/* The options for an `Input' entry in the project file. */
+struct aga_input {
+	char* path;
+	enum aga_file_kind kind;
+	asys_bool_t recurse;
+	asys_bool_t compress;
+	asys_bool_t strip;
+	asys_bool_t quantise;
 };
 
+/* Converters are given the job for its path and per-input options. */
 typedef enum asys_result (*aga_build_input_fn_t)(
-		struct asys_stream*, struct asys_stream*);
+		struct asys_stream*, struct asys_stream*, const struct aga_build_job*);
 
 typedef enum asys_result (*aga_input_iterfn_t)(
-		const char*, enum aga_file_kind, asys_bool_t, void*);
+		const struct aga_input*, void*);
 
 static enum asys_result aga_build_open_config(
 		const char* path, struct aga_config_node* root) {
@@ -140,38 +215,205 @@ static asys_bool_t aga_build_path_matches_kind(
 	return ASYS_TRUE;
 }
 
-static enum asys_result aga_fprintf_add(
-		struct asys_stream* stream, asys_size_t indent,
-		const char* format, ...) {
+static enum asys_result aga_build_python(
+		struct asys_stream* out, struct asys_stream* in,
+		const struct aga_build_job* job) {
 
 	enum asys_result result;
 
-	va_list list;
+	(void) job;
 
-	result = asys_stream_write_characters(stream, '\t', indent);
-	if(result) return result;
+	if((result = asys_stream_splice(out, in, ASYS_COPY_ALL))) return result;
+
+	return asys_stream_write(out, AGA_PY_TAIL, sizeof(AGA_PY_TAIL) - 1);
+}
+
+/*
+ * Vertices are welded by bucketing their positions into a grid of cells
+ * `AGA_BUILD_WELD_EPSILON' wide. Only vertices sharing a cell are compared so
+ * Welding stays linear in the vertex count -- near-identical vertices which
+ * Straddle a cell boundary are left apart, which costs a little size but
+ * Never correctness.
+ *
+ * TODO: Put this epsilon somewhere configurable.
+ */
+#define AGA_BUILD_WELD_EPSILON (0.0001f)
 
-	va_start(list, format);
+/* Hashed cells are clamped to this to stay in range of a 32-bit long. */
+#define AGA_BUILD_WELD_CELLS (1073741824.0f)
 
-	result = asys_stream_write_format_variadic(stream, format, list);
+struct aga_build_weld {
+	struct aga_model_vertex* vertices;
+	asys_uint_t count;
 
-	va_end(list);
+	/* Per-cell chains of vertex indices plus one -- zero terminates. */
+	asys_uint_t* buckets;
+	asys_uint_t* chain;
+	asys_size_t mask;
+};
 
-	return result;
+static asys_bool_t aga_build_weld_near(const float* a, const float* b) {
+	asys_size_t i;
+
+	for(i = 0; i < sizeof(struct aga_model_vertex) / sizeof(float); ++i) {
+		float d = a[i] - b[i];
+
+		if(d > AGA_BUILD_WELD_EPSILON || d < -AGA_BUILD_WELD_EPSILON) {
+			return ASYS_FALSE;
+		}
+	}
+
+	return ASYS_TRUE;
 }
 
-static enum asys_result aga_build_python(
-		struct asys_stream* out, struct asys_stream* in) {
+/* Yields the index of the vertex, adding it if nothing close enough exists. */
+static asys_uint_t aga_build_weld(
+		struct aga_build_weld* weld, const struct aga_model_vertex* vertex) {
 
-	enum asys_result result;
+	static const asys_size_t primes[] = { 73856093, 19349663, 83492791 };
 
-	if((result = asys_stream_splice(out, in, ASYS_COPY_ALL))) return result;
+	asys_size_t hash = 0;
+	asys_uint_t i;
 
-	return asys_stream_write(out, AGA_PY_TAIL, sizeof(AGA_PY_TAIL) - 1);
+	for(i = 0; i < 3; ++i) {
+		float cell = vertex->pos[i] / AGA_BUILD_WELD_EPSILON;
+
+		/*
+		 * The cast is undefined out of range -- far off cells are lumped
+		 * Together and NaNs go in cell zero, which only costs hash quality.
+		 */
+		if(cell != cell) cell = 0.0f;
+		else if(cell > AGA_BUILD_WELD_CELLS) cell = AGA_BUILD_WELD_CELLS;
+		else if(cell < -AGA_BUILD_WELD_CELLS) cell = -AGA_BUILD_WELD_CELLS;
+
+		hash ^= (asys_size_t) (asys_native_long_t) cell * primes[i];
+	}
+
+	hash &= weld->mask;
+
+	for(i = weld->buckets[hash]; i; i = weld->chain[i - 1]) {
+		const float* candidate = (const float*) &weld->vertices[i - 1];
+
+		if(aga_build_weld_near(candidate, (const float*) vertex)) return i - 1;
+	}
+
+	i = weld->count++;
+
+	weld->vertices[i] = *vertex;
+	weld->chain[i] = weld->buckets[hash];
+	weld->buckets[hash] = i + 1;
+
+	return i;
+}
+
+/*
+ * Vertices are only quantised where a step of their 16-bit UVs and positions
+ * Comes within these -- larger models keep full precision.
+ *
+ * TODO: Put these somewhere configurable.
+ */
+#define AGA_BUILD_UV_STEP (1.0f / 8192.0f)
+#define AGA_BUILD_POSITION_STEP (0.001f)
+
+static float aga_build_component(
+		const struct aga_model_vertex* vertex, asys_size_t i) {
+
+	return i < 2 ? vertex->uv[i] : vertex->pos[i - 2];
+}
+
+static signed char aga_build_normal(float n) {
+	float c = (n * 255.0f - 1.0f) / 2.0f;
+
+	if(c > 127.0f) return 127;
+	if(c < -128.0f) return -128;
+
+	return (signed char) (c < 0.0f ? c - 0.5f : c + 0.5f);
+}
+
+/*
+ * Packs vertices against their bounds -- see `aga_model_packed_vertex'.
+ * Leaves `*out' null where the model is too large to quantise.
+ */
+static enum asys_result aga_build_quantise(
+		const struct aga_model_vertex* vertices, asys_size_t count,
+		struct aga_model_header* header, struct aga_model_packed_vertex** out) {
+
+	float min[5], max[5];
+	asys_size_t i, j;
+
+	*out = 0;
+
+	if(!count) return ASYS_RESULT_OK;
+
+	for(j = 0; j < 5; ++j) {
+		min[j] = max[j] = aga_build_component(&vertices[0], j);
+	}
+
+	for(i = 1; i < count; ++i) {
+		for(j = 0; j < 5; ++j) {
+			float f = aga_build_component(&vertices[i], j);
+
+			if(f < min[j]) min[j] = f;
+			if(f > max[j]) max[j] = f;
+		}
+	}
+
+	for(j = 0; j < 5; ++j) {
+		float step = j < 2 ? AGA_BUILD_UV_STEP : AGA_BUILD_POSITION_STEP;
+
+		header->bias[j] = min[j];
+		header->scale[j] = (max[j] - min[j]) / 65535.0f;
+
+		if(header->scale[j] > step) {
+			asys_memory_zero(header->scale, sizeof(header->scale));
+			asys_memory_zero(header->bias, sizeof(header->bias));
+
+			return ASYS_RESULT_OK;
+		}
+	}
+
+	*out = asys_memory_allocate(count * sizeof(struct aga_model_packed_vertex));
+	if(!*out) return ASYS_RESULT_OOM;
+
+	for(i = 0; i < count; ++i) {
+		struct aga_model_packed_vertex* packed = &(*out)[i];
+		unsigned short q[5];
+
+		for(j = 0; j < 5; ++j) {
+			float f = aga_build_component(&vertices[i], j) - min[j];
+
+			if(header->scale[j] > 0.0f) f /= header->scale[j];
+
+			q[j] = (unsigned short) (f > 65535.0f ? 65535 : f + 0.5f);
+		}
+
+		packed->uv[0] = q[0];
+		packed->uv[1] = q[1];
+		packed->pos[0] = q[2];
+		packed->pos[1] = q[3];
+		packed->pos[2] = q[4];
+
+		for(j = 0; j < 3; ++j) {
+			packed->norm[j] = aga_build_normal(vertices[i].norm[j]);
+		}
+
+		packed->pad = 0;
+	}
+
+	header->flags |= AGA_MODEL_QUANTISED;
+
+	return ASYS_RESULT_OK;
 }
 
+/*
+ * Once welded, triangles are reordered for the post-transform vertex cache
+ * And vertices for fetch locality. Inputs with `Strip' set are then stored
+ * As a single triangle strip for the fixed-function path. Vertices are then
+ * Quantised where the model is small enough.
+ */
 static enum asys_result aga_build_obj(
-		struct asys_stream* out, struct asys_stream* in) {
+		struct asys_stream* out, struct asys_stream* in,
+		const struct aga_build_job* job) {
 
 	enum asys_result result;
 
@@ -181,6 +423,17 @@ static enum asys_result aga_build_obj(
 	unsigned i, j;
 	GLMgroup* group;
 
+	struct aga_build_weld weld = { 0 };
+	struct aga_model_header header = { 0 };
+	asys_uint_t* indices = 0;
+	asys_size_t count = 0, buckets = 1;
+
+	asys_uint_t* strip = 0;
+	asys_size_t strip_count;
+	float before, after;
+
+	struct aga_model_packed_vertex* packed = 0;
+
 	void* stdc_handle;
 
 	/* TODO: This needs to be closed. */
@@ -188,29 +441,43 @@ static enum asys_result aga_build_obj(
 	if(!stdc_handle) return ASYS_RESULT_NOT_IMPLEMENTED;
 
 	/* TODO: Handle different EH. */
-	model = glmReadOBJFile(AGA_BUILD_FNAME, asys_stream_stdc(in));
+	model = glmReadOBJFile(job->path, asys_stream_stdc(in));
 	if(!model) return ASYS_RESULT_OOM;
 
-	/* TODO: Put this epsilon somewhere configurable. */
-	/* TODO: This hangs? (Or takes a *really* long time on sponza or smth.) */
-	/* glmWeld(model, 0.0001f); */
 	glmExtent(model, extent);
 
+	for(group = model->groups; group; group = group->next) {
+		count += 3 * group->ntris;
+	}
+
+	while(buckets < count * 2) buckets <<= 1;
+	weld.mask = buckets - 1;
+
+	weld.vertices = asys_memory_allocate(
+			(count + 1) * sizeof(struct aga_model_vertex));
+
+	weld.buckets = asys_memory_allocate_zero(buckets, sizeof(asys_uint_t));
+	weld.chain = asys_memory_allocate((count + 1) * sizeof(asys_uint_t));
+	indices = asys_memory_allocate((count + 1) * sizeof(asys_uint_t));
+
+	if(!weld.vertices || !weld.buckets || !weld.chain || !indices) {
+		result = ASYS_RESULT_OOM;
+		goto cleanup;
+	}
+
+	header.indices = 0;
+
 	group = model->groups;
 	while(group) {
 		const GLMtriangle* tris = model->tris;
-		const GLMmaterial* mats = model->mats;
 		const float* norms = model->norms;
 		const float* uvs = model->uvs;
 		const float* verts = model->verts;
 
 		for(i = 0; i < group->ntris; i++) {
 			const GLMtriangle* t = &tris[group->tris[i]];
-			const GLMmaterial* mat = &mats[group->material];
 
-			struct aga_vertex v = { 0 };
-
-			if(mat) asys_memory_copy(v.col, mat->diffuse, sizeof(float[4]));
+			struct aga_model_vertex v;
 
 			for(j = 0; j < 3; ++j) {
 				asys_memory_copy(
@@ -222,417 +489,1655 @@ static enum asys_result aga_build_obj(
 				asys_memory_copy(
 						v.pos, &verts[3 * t->v_inds[j]], sizeof(float[3]));
 
-				result = asys_stream_write(out, &v, sizeof(struct aga_vertex));
-				if(result) goto cleanup;
+				indices[header.indices++] = aga_build_weld(&weld, &v);
 			}
 		}
 
 		group = group->next;
 	}
 
-	result = asys_stream_write(out, &extent, sizeof(float[6]));
+	result = aga_mesh_acmr(
+			indices, header.indices, weld.count, AGA_MESH_FIFO, &before);
 
-	cleanup: glmDelete(model);
+	if(result) goto cleanup;
 
-	return result;
+	result = aga_mesh_order(indices, header.indices, weld.count);
+	if(result) goto cleanup;
 
-}
+	result = aga_mesh_fetch(
+			indices, header.indices, weld.vertices, weld.count,
+			sizeof(struct aga_model_vertex), &count);
 
-static enum asys_result aga_build_tiff(
-		struct asys_stream* out, struct asys_stream* in) {
+	if(result) goto cleanup;
 
-	/* NOTE: TIFF wants this -- this is kind of evil. */
-	static char msg[1024];
+	weld.count = (asys_uint_t) count;
 
-	enum asys_result result = ASYS_RESULT_OK;
+	result = aga_mesh_acmr(
+			indices, header.indices, weld.count, AGA_MESH_FIFO, &after);
 
-	asys_stream_native_t native = asys_stream_native(in);
+	if(result) goto cleanup;
 
-	TIFF* tiff;
-	TIFFRGBAImage img = { 0 };
+	asys_log(
+			__FILE__, "Model `%s': ACMR %.3f -> %.3f (%u triangles)",
+			job->path, before, after, header.indices / 3);
 
-	asys_size_t size;
-	void* raster = 0;
+	header.vertices = weld.count;
+	header.index_size = weld.count > 0x10000 ? 4 : 2;
+	header.flags = 0;
 
-	if(!(tiff = TIFFFdOpen(native, AGA_BUILD_FNAME, "r"))) {
-		return ASYS_RESULT_ERROR;
-	}
+	if(job->strip) {
+		result = aga_mesh_strip(
+				indices, header.indices, weld.count, &strip, &strip_count);
 
-	if(!TIFFRGBAImageBegin(&img, tiff, 0, msg)) {
-		asys_log(__FILE__, "err: Failed to read TIFF file: %s", msg);
-		result = ASYS_RESULT_ERROR;
-		goto cleanup;
+		if(result) goto cleanup;
+
+		/* Heavily disconnected models can come out larger as a strip. */
+		if(strip_count < header.indices) {
+			asys_memory_free(indices);
+			indices = strip;
+			strip = 0;
+
+			header.indices = (asys_uint_t) strip_count;
+			header.flags |= AGA_MODEL_STRIP;
+		}
+		else {
+			asys_log(
+					__FILE__,
+					"warn: Model `%s' does not strip well -- storing it as a"
+					" triangle list", job->path);
+		}
 	}
 
-	size = 4 * img.width * img.height;
+	result = aga_build_quantise(weld.vertices, weld.count, &header, &packed);
+	if(result) goto cleanup;
 
-	if(!(raster = asys_memory_allocate(size))) {
-		result = ASYS_RESULT_OOM;
-		goto cleanup;
+	if(!packed) {
+		asys_log(
+				__FILE__,
+				"warn: Model `%s' is too large to quantise -- storing full"
+				" precision vertices", job->path);
 	}
 
-	if(!TIFFRGBAImageGet(&img, raster, img.width, img.height)) {
-		result = ASYS_RESULT_ERROR;
-		goto cleanup;
+	result = asys_stream_write(out, &header, sizeof(header));
+	if(result) goto cleanup;
+
+	if(packed) {
+		static const asys_uchar_t padding[4] = { 0 };
+
+		count = weld.count * sizeof(struct aga_model_packed_vertex);
+
+		result = asys_stream_write(out, packed, count);
+		if(result) goto cleanup;
+
+		result = asys_stream_write(
+				out, padding, AGA_MODEL_ALIGN(count) - count);
+	}
+	else {
+		result = asys_stream_write(
+				out, weld.vertices,
+				weld.count * sizeof(struct aga_model_vertex));
 	}
 
-	result = asys_stream_write(out, raster, size);
 	if(result) goto cleanup;
 
-	result = asys_stream_write(out, &img.width, sizeof(uint32));
+	/* Narrowing in-place is safe as it never overtakes the read position. */
+	if(header.index_size == 2) {
+		unsigned short* narrow = (unsigned short*) indices;
+
+		for(i = 0; i < header.indices; ++i) {
+			narrow[i] = (unsigned short) indices[i];
+		}
+	}
+
+	result = asys_stream_write(
+			out, indices, header.indices * header.index_size);
+
 	if(result) goto cleanup;
 
+	result = asys_stream_write(out, &extent, sizeof(float[6]));
+
 	cleanup: {
-		asys_memory_free(raster);
-		TIFFRGBAImageEnd(&img);
-		TIFFClose(tiff, 0);
+		asys_memory_free(packed);
+		asys_memory_free(strip);
+		asys_memory_free(indices);
+		asys_memory_free(weld.chain);
+		asys_memory_free(weld.buckets);
+		asys_memory_free(weld.vertices);
+
+		glmDelete(model);
+
+		return result;
 	}
+}
 
-	return result;
+static enum asys_result aga_build_sgml(
+		struct asys_stream* out, struct asys_stream* in,
+		const struct aga_build_job* job) {
+
+	enum asys_result result;
+
+	struct aga_config_node root;
+
+	(void) job;
+
+	result = aga_config_new(in, AGA_CONFIG_EOF, &root);
+	if(result) {
+		asys_log_result(
+				__FILE__, "aga_config_delete", aga_config_delete(&root));
+
+		return result;
+	}
+
+	result = aga_config_compile(&root, out);
+	if(result) {
+		asys_log_result(
+				__FILE__, "aga_config_delete", aga_config_delete(&root));
+
+		return result;
+	}
+
+	return aga_config_delete(&root);
 }
 
-static enum asys_result aga_build_input_file(
-		const char* path, enum aga_file_kind kind) {
+/*
+ * The smallest power of two no less than `n' -- rounding up so that none of
+ * The source's resolution is thrown away.
+ */
+static asys_uint_t aga_build_pow2(asys_uint_t n) {
+	asys_uint_t pow2 = 1;
 
-	static asys_fixed_buffer_t buffer = { 0 };
+	while(pow2 < n) pow2 <<= 1;
 
-	enum asys_result result;
+	return pow2;
+}
 
-	aga_build_input_fn_t fn;
-	struct asys_stream in, out;
+/*
+ * Resamples a line of RGBA pixels `stride' floats apart with a tent filter.
+ * When shrinking, the filter widens to cover every source pixel so nothing
+ * Is skipped over.
+ */
+static void aga_build_resample(
+		const float* in, asys_size_t in_count, float* out,
+		asys_size_t out_count, asys_size_t stride) {
 
-	asys_bool_t older;
+	double scale = (double) out_count / (double) in_count;
+	double support = scale < 1.0 ? 1.0 / scale : 1.0;
+	asys_size_t i, j;
 
-	/*
-	 * Input kinds which are handled as "raw" need a special case when
-	 * Looking for the resultant artefact files -- we just redirect to the
-	 * Original because there is no need to produce any output whatsoever.
-	 */
-	if(kind == AGA_KIND_SGML || kind == AGA_KIND_RAW) return ASYS_RESULT_OK;
+	for(i = 0; i < out_count; ++i) {
+		double centre = ((double) i + 0.5) / scale - 0.5;
+		double sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+		double total = 0.0;
+		asys_native_long_t lo = (asys_native_long_t) (centre - support);
+		asys_native_long_t hi = (asys_native_long_t) (centre + support) + 1;
+		asys_native_long_t k;
+
+		for(k = lo - 1; k <= hi; ++k) {
+			double d = (double) k - centre;
+			double weight = 1.0 - (d < 0.0 ? -d : d) / support;
+			const float* pixel;
+
+			if(weight <= 0.0) continue;
+
+			/* Edges are clamped. */
+			if(k < 0) pixel = in;
+			else if(k >= (asys_native_long_t) in_count) {
+				pixel = &in[(in_count - 1) * stride];
+			}
+			else pixel = &in[k * stride];
 
-	/* Skip input files which don't match kind. */
-	if(!aga_build_path_matches_kind(path, kind)) return ASYS_RESULT_OK;
+			for(j = 0; j < 4; ++j) sum[j] += weight * pixel[j];
+			total += weight;
+		}
 
-	buffer[0] = 0;
+		for(j = 0; j < 4; ++j) out[i * stride + j] = (float) (sum[j] / total);
+	}
+}
 
-	asys_string_concatenate(buffer, path);
-	asys_string_concatenate(buffer, AGA_RAW_SUFFIX);
+/* Resamples a whole RGBA image -- rows and then columns. */
+static enum asys_result aga_build_resize(
+		const float* in, asys_uint_t in_width, asys_uint_t in_height,
+		float* out, asys_uint_t out_width, asys_uint_t out_height) {
+
+	asys_size_t i;
+	float* rows;
+
+	rows = asys_memory_allocate(4 * out_width * in_height * sizeof(float));
+	if(!rows) return ASYS_RESULT_OOM;
+
+	for(i = 0; i < in_height; ++i) {
+		aga_build_resample(
+				&in[4 * in_width * i], in_width, &rows[4 * out_width * i],
+				out_width, 4);
+	}
+
+	for(i = 0; i < out_width; ++i) {
+		aga_build_resample(
+				&rows[4 * i], in_height, &out[4 * i], out_height,
+				4 * out_width);
+	}
+
+	asys_memory_free(rows);
+
+	return ASYS_RESULT_OK;
+}
+
+/*
+ * Picks the smallest format which holds the image without loss -- or with
+ * `quantise', the smallest 16-bit format where that would be smaller still.
+ */
+static enum aga_image_format aga_build_format(
+		const asys_uchar_t* rgba, asys_size_t count, asys_bool_t quantise) {
+
+	asys_bool_t grey = ASYS_TRUE;
+	asys_bool_t opaque = ASYS_TRUE;
+	asys_bool_t binary = ASYS_TRUE;
+	asys_size_t i;
+
+	for(i = 0; i < count; ++i, rgba += 4) {
+		if(rgba[0] != rgba[1] || rgba[0] != rgba[2]) grey = ASYS_FALSE;
+		if(rgba[3] != 0xFF) opaque = ASYS_FALSE;
+		if(rgba[3] != 0xFF && rgba[3] != 0) binary = ASYS_FALSE;
+	}
+
+	if(grey) return opaque ? AGA_IMAGE_LUMINANCE : AGA_IMAGE_LUMINANCE_ALPHA;
+
+	if(quantise) {
+		if(opaque) return AGA_IMAGE_R5_G6_B5;
+		return binary ? AGA_IMAGE_RGB5_A1 : AGA_IMAGE_RGBA4;
+	}
+
+	return opaque ? AGA_IMAGE_RGB : AGA_IMAGE_RGBA;
+}
+
+/* Rounds an 8-bit channel to `bits' bits. */
+#define AGA_BUILD_QUANTISE(c, bits) \
+		((((asys_uint_t) (c) * ((1U << (bits)) - 1)) + 127) / 255)
 
-	result = asys_path_older(path, buffer, &older);
-	/* If we can't determine the age of the files -- rebuild anyway. */
-	asys_log_result(__FILE__, "asys_path_older", result);
+/*
+ * Converts RGBA pixels to `format' in-place, yielding the size of the
+ * Result. No format is larger than RGBA so writes never overtake reads.
+ */
+static asys_size_t aga_build_texels(
+		asys_uchar_t* pixels, asys_size_t count, enum aga_image_format format) {
+
+	const asys_uchar_t* in = pixels;
+	unsigned short* packed = (unsigned short*) pixels;
+	asys_size_t i;
+
+	if(format == AGA_IMAGE_RGBA) return 4 * count;
+
+	for(i = 0; i < count; ++i, in += 4) {
+		asys_uint_t r = in[0], g = in[1], b = in[2], a = in[3];
+
+		switch(format) {
+			default: break;
+
+			case AGA_IMAGE_RGB: {
+				pixels[3 * i + 0] = (asys_uchar_t) r;
+				pixels[3 * i + 1] = (asys_uchar_t) g;
+				pixels[3 * i + 2] = (asys_uchar_t) b;
+
+				break;
+			}
+
+			case AGA_IMAGE_LUMINANCE: pixels[i] = (asys_uchar_t) r; break;
+
+			case AGA_IMAGE_LUMINANCE_ALPHA: {
+				pixels[2 * i + 0] = (asys_uchar_t) r;
+				pixels[2 * i + 1] = (asys_uchar_t) a;
+
+				break;
+			}
+
+			/* As GL's packed pixel types -- red is most significant. */
+			case AGA_IMAGE_RGBA4: {
+				packed[i] = (unsigned short) (
+						(AGA_BUILD_QUANTISE(r, 4) << 12) |
+						(AGA_BUILD_QUANTISE(g, 4) << 8) |
+						(AGA_BUILD_QUANTISE(b, 4) << 4) |
+						AGA_BUILD_QUANTISE(a, 4));
+
+				break;
+			}
+
+			case AGA_IMAGE_RGB5_A1: {
+				packed[i] = (unsigned short) (
+						(AGA_BUILD_QUANTISE(r, 5) << 11) |
+						(AGA_BUILD_QUANTISE(g, 5) << 6) |
+						(AGA_BUILD_QUANTISE(b, 5) << 1) |
+						(a >= 0x80));
+
+				break;
+			}
+
+			case AGA_IMAGE_R5_G6_B5: {
+				packed[i] = (unsigned short) (
+						(AGA_BUILD_QUANTISE(r, 5) << 11) |
+						(AGA_BUILD_QUANTISE(g, 6) << 5) |
+						AGA_BUILD_QUANTISE(b, 5));
+
+				break;
+			}
+		}
+	}
+
+	if(format == AGA_IMAGE_RGB) return 3 * count;
+	if(format == AGA_IMAGE_LUMINANCE) return count;
+
+	return 2 * count;
+}
+
+/*
+ * Images are resized to a power of two and written along with their full mip
+ * Chain -- see `aga_image_header'. Each level is filtered down from the one
+ * Before it, and all levels are stored in the format picked for the largest.
+ */
+static enum asys_result aga_build_tiff(
+		struct asys_stream* out, struct asys_stream* in,
+		const struct aga_build_job* job) {
+
+	/* NOTE: TIFF wants this -- this is kind of evil. */
+	char msg[1024];
+
+	enum asys_result result = ASYS_RESULT_OK;
+
+	asys_stream_native_t native = asys_stream_native(in);
+
+	TIFF* tiff;
+	TIFFRGBAImage img = { 0 };
+
+	struct aga_image_header header;
+	asys_uint_t width, height;
+
+	asys_size_t size, staging, i;
+	asys_uchar_t* raster = 0;
+	asys_uchar_t* level = 0;
+	float* current = 0;
+	float* next = 0;
+
+	if(!(tiff = TIFFFdOpen(native, job->path, "r"))) {
+		return ASYS_RESULT_ERROR;
+	}
+
+	if(!TIFFRGBAImageBegin(&img, tiff, 0, msg)) {
+		asys_log(__FILE__, "err: Failed to read TIFF file: %s", msg);
+		result = ASYS_RESULT_ERROR;
+		goto cleanup;
+	}
+
+	size = 4 * img.width * img.height;
+
+	if(!(raster = asys_memory_allocate(size))) {
+		result = ASYS_RESULT_OOM;
+		goto cleanup;
+	}
+
+	if(!TIFFRGBAImageGet(&img, raster, img.width, img.height)) {
+		result = ASYS_RESULT_ERROR;
+		goto cleanup;
+	}
+
+	header.width = width = aga_build_pow2(img.width);
+	header.height = height = aga_build_pow2(img.height);
+
+	header.levels = 1;
+	for(i = width > height ? width : height; i > 1; i >>= 1) header.levels++;
+
+	/* `next' first holds the source so must fit whichever is larger. */
+	staging = (asys_size_t) width * height;
+	if(staging < (asys_size_t) img.width * img.height) {
+		staging = (asys_size_t) img.width * img.height;
+	}
+
+	current = asys_memory_allocate(4 * width * height * sizeof(float));
+	next = asys_memory_allocate(4 * staging * sizeof(float));
+	level = asys_memory_allocate(4 * width * height);
+
+	if(!current || !next || !level) {
+		result = ASYS_RESULT_OOM;
+		goto cleanup;
+	}
+
+	for(i = 0; i < size; ++i) next[i] = raster[i];
+
+	if(width != img.width || height != img.height) {
+		asys_log(
+				__FILE__,
+				"warn: Image `%s' is not a power of two -- resizing from %ux%u"
+				" to %ux%u", job->path, img.width, img.height, width, height);
+
+		result = aga_build_resize(
+				next, img.width, img.height, current, width, height);
+
+		if(result) goto cleanup;
+	}
+	else {
+		float* swap = current;
+
+		current = next;
+		next = swap;
+	}
+
+	for(;;) {
+		float* swap;
+
+		size = 4 * width * height;
+
+		for(i = 0; i < size; ++i) {
+			float f = current[i] + 0.5f;
+
+			level[i] = (asys_uchar_t) (f < 0.0f ? 0 : f > 255.0f ? 255 : f);
+		}
+
+		if(width == header.width && height == header.height) {
+			header.format = aga_build_format(
+					level, width * height, job->quantise);
+
+			result = asys_stream_write(out, &header, sizeof(header));
+			if(result) goto cleanup;
+		}
+
+		size = aga_build_texels(level, width * height, header.format);
+
+		result = asys_stream_write(out, level, size);
+		if(result) goto cleanup;
+
+		if(width == 1 && height == 1) break;
+
+		result = aga_build_resize(
+				current, width, height, next,
+				width > 1 ? width / 2 : 1, height > 1 ? height / 2 : 1);
+
+		if(result) goto cleanup;
+
+		if(width > 1) width /= 2;
+		if(height > 1) height /= 2;
+
+		swap = current;
+		current = next;
+		next = swap;
+	}
+
+	result = asys_stream_write(out, &header.width, sizeof(aga_image_tail_t));
+	if(result) goto cleanup;
+
+	cleanup: {
+		asys_memory_free(next);
+		asys_memory_free(current);
+		asys_memory_free(level);
+		asys_memory_free(raster);
+		TIFFRGBAImageEnd(&img);
+		TIFFClose(tiff, 0);
+	}
+
+	return result;
+}
+
+/*
+ * Converters are versioned so that stale artefacts are rebuilt when their
+ * Output changes -- bump the relevant entry alongside any such change.
+ */
+static const asys_uint_t aga_build_versions[] = {
+		0, /* AGA_KIND_NONE */
+		0, /* AGA_KIND_RAW */
+		4, /* AGA_KIND_TIFF */
+		4, /* AGA_KIND_OBJ */
+		2, /* AGA_KIND_SGML */
+		1, /* AGA_KIND_PY */
+		0, /* AGA_KIND_WAV */
+		0 /* AGA_KIND_MIDI */
+};
+
+/* FNV-1a -- continues from `hash' so data can be fed through in pieces. */
+static asys_uint_t aga_build_hash(
+		asys_uint_t hash, const void* data, asys_size_t size) {
+
+	const asys_uchar_t* bytes = data;
+	asys_size_t i;
+
+	for(i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash = (asys_uint_t) ((hash * 16777619UL) & 0xFFFFFFFFUL);
+	}
+
+	return hash;
+}
+
+/* Compression is left out of the key as it is applied at pack time. */
+static enum asys_result aga_build_stamp(
+		struct asys_stream* stream, const struct aga_build_job* job,
+		struct aga_build_stamp* stamp) {
+
+	enum asys_result result;
+
+	asys_uchar_t block[AGA_BUILD_HASH_BLOCK];
+	asys_size_t count;
+
+	enum aga_file_kind kind = job->kind;
+	asys_uint_t version = aga_build_versions[kind];
+	asys_uint_t options = (!!job->strip) | ((!!job->quantise) << 1);
+
+	stamp->hash = (asys_uint_t) 2166136261UL;
+	stamp->size = 0;
+
+	do {
+		result = asys_stream_read(stream, &count, block, sizeof(block));
+		if(result && result != ASYS_RESULT_EOF) return result;
+
+		stamp->hash = aga_build_hash(stamp->hash, block, count);
+		stamp->size += count;
+	} while(count);
+
+	stamp->key = aga_build_hash(
+			(asys_uint_t) 2166136261UL, &kind, sizeof(kind));
+
+	stamp->key = aga_build_hash(stamp->key, &version, sizeof(version));
+	stamp->key = aga_build_hash(stamp->key, &options, sizeof(options));
+
+	return ASYS_RESULT_OK;
+}
+
+static enum asys_result aga_build_input_file(struct aga_build_job* job) {
+	asys_fixed_buffer_t buffer = { 0 };
+
+	enum asys_result result;
+
+	aga_build_input_fn_t fn;
+	struct asys_stream in, out;
+
+	union asys_file_attribute attribute;
+
+	const char* path = job->path;
+	enum aga_file_kind kind = job->kind;
+
+	/*
+	 * Input kinds which are handled as "raw" need a special case when
+	 * Looking for the resultant artefact files -- we just redirect to the
+	 * Original because there is no need to produce any output whatsoever.
+	 */
+	if(kind == AGA_KIND_RAW) return ASYS_RESULT_OK;
+
+	asys_string_concatenate(buffer, path);
+	asys_string_concatenate(buffer, AGA_RAW_SUFFIX);
+
+	result = asys_stream_new(&in, path);
+	if(result) return result;
+
+	if((result = aga_build_stamp(&in, job, &job->current))) {
+		asys_log_result(
+				__FILE__, "asys_stream_delete", asys_stream_delete(&in));
+
+		return result;
+	}
+
+	/*
+	 * Only inputs whose content or converter have changed since the last
+	 * Build need converting -- unless the artefact has since gone missing.
+	 */
+	if(job->known &&
+		job->previous.hash == job->current.hash &&
+		job->previous.size == job->current.size &&
+		job->previous.key == job->current.key) {
+
+		result = asys_path_attribute(buffer, ASYS_FILE_TYPE, &attribute);
+		if(!result) return asys_stream_delete(&in);
+	}
+
+	if((result = asys_stream_seek(&in, ASYS_SEEK_SET, 0))) {
+		asys_log_result(
+				__FILE__, "asys_stream_delete", asys_stream_delete(&in));
+
+		return result;
+	}
+
+	result = asys_stream_new_write(&out, buffer);
+	if(result) goto cleanup;
+
+	switch(kind) {
+		default: {
+			asys_log(
+					__FILE__,
+					"err: Unknown or unimplemented input kind for `%s'", path);
+
+			goto cleanup;
+		}
+
+		case AGA_KIND_PY: fn = aga_build_python; break;
+		case AGA_KIND_OBJ: fn = aga_build_obj; break;
+		case AGA_KIND_TIFF: fn = aga_build_tiff; break;
+		case AGA_KIND_SGML: fn = aga_build_sgml; break;
+
+/*
+		case AGA_KIND_WAV: break;
+		case AGA_KIND_MIDI: break;
+ */
+	}
+
+	result = fn(&out, &in, job);
+	if(result) goto cleanup;
+
+	result = asys_stream_delete(&in);
+	if(result) goto cleanup;
+
+	return asys_stream_delete(&out);
+
+	cleanup: {
+		asys_log_result(
+				__FILE__, "asys_stream_delete", asys_stream_delete(&in));
+
+		asys_log_result(
+				__FILE__, "asys_stream_delete", asys_stream_delete(&out));
+
+		return result;
+	}
+}
+
+static asys_bool_t aga_build_cache_read(
+		struct aga_config_node* node, struct aga_build_stamp* stamp) {
+
+	static const char* hash = "Hash";
+	static const char* size = "Size";
+	static const char* key = "Key";
+
+	aga_config_int_t values[3];
+	struct aga_config_query queries[3];
+	asys_size_t i;
+
+	queries[0].names = &hash;
+	queries[1].names = &size;
+	queries[2].names = &key;
+
+	for(i = 0; i < ASYS_LENGTH(queries); ++i) {
+		queries[i].count = 1;
+		queries[i].type = AGA_INTEGER;
+		queries[i].value = &values[i];
+	}
+
+	if(aga_config_lookup_all(node, queries, ASYS_LENGTH(queries))) {
+		return ASYS_FALSE;
+	}
+
+	for(i = 0; i < ASYS_LENGTH(queries); ++i) {
+		if(queries[i].result) return ASYS_FALSE;
+	}
+
+	stamp->hash = (asys_uint_t) values[0];
+	stamp->size = (asys_size_t) values[1];
+	stamp->key = (asys_uint_t) values[2];
+
+	return ASYS_TRUE;
+}
+
+static void aga_build_cache_find(
+		struct aga_build_input_pass* pass, struct aga_build_job* job) {
+
+	struct aga_config_node* node;
+
+	/* Inputs new to the build are expected to be missing. */
+	if(aga_config_lookup_raw(
+			pass->cached, (const char**) &job->path, 1, &node)) {
+
+		return;
+	}
+
+	pass->seen[node - pass->cached->children] = ASYS_TRUE;
+
+	job->known = aga_build_cache_read(node, &job->previous);
+}
+
+static enum asys_result aga_build_cache_open(
+		const char* path, struct aga_build_input_pass* pass) {
+
+	static const char* cache = "Cache";
+
+	enum asys_result result;
+
+	struct aga_config_node* node;
+
+	if(aga_build_open_config(path, &pass->cache)) {
+		asys_log(
+				__FILE__,
+				"warn: No usable build cache `%s' -- converting all inputs",
+				path);
+
+		return ASYS_RESULT_OK;
+	}
+
+	result = aga_config_lookup_check(pass->cache.children, &cache, 1, &node);
+	if(result) {
+		asys_log(__FILE__, "warn: Malformed build cache `%s'", path);
+		return aga_config_delete(&pass->cache);
+	}
+
+	pass->seen = asys_memory_allocate_zero(node->len + 1, sizeof(asys_bool_t));
+	if(!pass->seen) {
+		asys_log_result(
+				__FILE__, "aga_config_delete", aga_config_delete(&pass->cache));
+
+		return ASYS_RESULT_OOM;
+	}
+
+	pass->cached = node;
+
+	return ASYS_RESULT_OK;
+}
+
+/*
+ * Entries are found by name, so of any duplicates (as from an input being
+ * Listed twice) only the first is ever seen.
+ */
+static asys_bool_t aga_build_cache_stale(
+		struct aga_build_input_pass* pass, asys_size_t index) {
+
+	struct aga_config_node* node = &pass->cached->children[index];
+	struct aga_config_node* first;
+
+	if(!node->name) return ASYS_FALSE;
+
+	if(aga_config_lookup_raw(
+			pass->cached, (const char**) &node->name, 1, &first)) {
+
+		return ASYS_TRUE;
+	}
+
+	return !pass->seen[first - pass->cached->children];
+}
+
+static enum asys_result aga_build_cache_item(
+		struct asys_stream* stream, const char* name,
+		const struct aga_build_stamp* stamp) {
+
+	static const char item[] =
+			"\t\t<item name=\"%s\">\n"
+			"\t\t\t<item name=\"Hash\" type=\"Integer\">\n"
+			"\t\t\t\t" ASYS_NATIVE_ULONG_FORMAT "\n"
+			"\t\t\t</item>\n"
+			"\t\t\t<item name=\"Size\" type=\"Integer\">\n"
+			"\t\t\t\t" ASYS_NATIVE_ULONG_FORMAT "\n"
+			"\t\t\t</item>\n"
+			"\t\t\t<item name=\"Key\" type=\"Integer\">\n"
+			"\t\t\t\t" ASYS_NATIVE_ULONG_FORMAT "\n"
+			"\t\t\t</item>\n"
+			"\t\t</item>\n";
+
+	return asys_stream_write_format(
+			stream, item, name, (asys_native_ulong_t) stamp->hash,
+			(asys_native_ulong_t) stamp->size,
+			(asys_native_ulong_t) stamp->key);
+}
+
+/*
+ * Only inputs which converted successfully are recorded. Entries for inputs
+ * Which have since left the build are carried over unless they were cleaned
+ * So that a later clean can still find them.
+ */
+static enum asys_result aga_build_cache_write(
+		const char* path, struct aga_build_input_pass* pass,
+		asys_bool_t cleaned) {
+
+	static const char header[] = "<root>\n\t<item name=\"Cache\">\n";
+	static const char footer[] = "\t</item>\n</root>\n";
+	enum asys_result result;
+
+	struct asys_stream stream;
+	asys_size_t i;
+
+	if((result = asys_stream_new_write(&stream, path))) return result;
+
+	result = asys_stream_write(&stream, header, sizeof(header) - 1);
+	if(result) goto cleanup;
+
+	for(i = 0; i < pass->count; ++i) {
+		struct aga_build_job* job = &pass->jobs[i];
+
+		if(job->result || job->kind == AGA_KIND_RAW) continue;
+
+		result = aga_build_cache_item(&stream, job->path, &job->current);
+		if(result) goto cleanup;
+	}
+
+	for(i = 0; !cleaned && pass->cached && i < pass->cached->len; ++i) {
+		struct aga_config_node* node = &pass->cached->children[i];
+		struct aga_build_stamp stamp;
+
+		if(!aga_build_cache_stale(pass, i)) continue;
+		if(!aga_build_cache_read(node, &stamp)) continue;
+
+		result = aga_build_cache_item(&stream, node->name, &stamp);
+		if(result) goto cleanup;
+	}
+
+	result = asys_stream_write(&stream, footer, sizeof(footer) - 1);
+	if(result) goto cleanup;
+
+	return asys_stream_delete(&stream);
+
+	cleanup: {
+		asys_log_result(
+				__FILE__, "asys_stream_delete", asys_stream_delete(&stream));
+
+		return result;
+	}
+}
+
+/* Removes the artefacts of anything which has dropped out of the build. */
+static void aga_build_cache_clean(struct aga_build_input_pass* pass) {
+	enum asys_result result;
+
+	asys_size_t i;
+
+	for(i = 0; i < pass->cached->len; ++i) {
+		struct aga_config_node* node = &pass->cached->children[i];
+
+		union asys_file_attribute attribute;
+		asys_fixed_buffer_t buffer = { 0 };
+
+		if(!aga_build_cache_stale(pass, i)) continue;
+
+		asys_string_concatenate(buffer, node->name);
+		asys_string_concatenate(buffer, AGA_RAW_SUFFIX);
+
+		/* Stale artefacts may well have been removed by hand already. */
+		result = asys_path_attribute(buffer, ASYS_FILE_TYPE, &attribute);
+		if(result) continue;
+
+		asys_log(__FILE__, "Removing stale artefact `%s'...", buffer);
+
+		result = asys_path_remove(buffer);
+		asys_log_result_path(__FILE__, "asys_path_remove", buffer, result);
+	}
+}
+
+static enum asys_result aga_build_queue(
+		const char* path, struct aga_build_input_pass* pass) {
+
+	struct aga_build_job* jobs;
+	struct aga_build_job* job;
+
+	asys_size_t size = (pass->count + 1) * sizeof(struct aga_build_job);
+
+	/* Skip input files which don't match kind. */
+	if(!aga_build_path_matches_kind(path, pass->kind)) return ASYS_RESULT_OK;
+
+	if(!(jobs = asys_memory_reallocate(pass->jobs, size))) {
+		return ASYS_RESULT_OOM;
+	}
+
+	pass->jobs = jobs;
+	job = &jobs[pass->count];
+
+	if(!(job->path = asys_string_duplicate(path))) return ASYS_RESULT_OOM;
+
+	job->kind = pass->kind;
+	job->compress = pass->compress;
+	job->strip = pass->strip;
+	job->quantise = pass->quantise;
+	job->result = ASYS_RESULT_OK;
+	job->known = ASYS_FALSE;
+
+	pass->count++;
+
+	if(pass->cached && job->kind != AGA_KIND_RAW) {
+		aga_build_cache_find(pass, job);
+	}
+
+	return ASYS_RESULT_OK;
+}
+
+/*
+ * Maps names to their index in an array so that matching up job paths and
+ * Directory entries is not quadratic. The map owns `names', but not the
+ * Strings they point to.
+ */
+struct aga_build_names {
+	const char** names;
+	asys_size_t count;
+
+	asys_size_t* slots; /* Indices plus one -- zero marks an empty slot. */
+	asys_size_t mask;
+};
+
+/* The first of any repeated name wins, as with a linear search. */
+static enum asys_result aga_build_names_new(
+		struct aga_build_names* map, const char** names, asys_size_t count) {
+
+	asys_size_t i, size = 1;
+
+	/* Keep the load factor at or below one half. */
+	while(size < count * 2) size <<= 1;
+
+	map->slots = asys_memory_allocate_zero(size, sizeof(asys_size_t));
+	if(!map->slots) return ASYS_RESULT_OOM;
+
+	map->names = names;
+	map->count = count;
+	map->mask = size - 1;
+
+	for(i = 0; i < count; ++i) {
+		asys_size_t slot = aga_resource_pack_hash(names[i]) & map->mask;
+
+		while(map->slots[slot]) {
+			const char* other = names[map->slots[slot] - 1];
+
+			if(asys_string_equal(other, names[i])) break;
+
+			slot = (slot + 1) & map->mask;
+		}
+
+		if(!map->slots[slot]) map->slots[slot] = i + 1;
+	}
+
+	return ASYS_RESULT_OK;
+}
+
+/* Yields the index of `name' -- or the name count if it is not present. */
+static asys_size_t aga_build_names_find(
+		const struct aga_build_names* map, const char* name) {
+
+	asys_size_t slot = aga_resource_pack_hash(name) & map->mask;
+
+	while(map->slots[slot]) {
+		asys_size_t i = map->slots[slot] - 1;
+
+		if(asys_string_equal(map->names[i], name)) return i;
+
+		slot = (slot + 1) & map->mask;
+	}
+
+	return map->count;
+}
+
+static void aga_build_names_delete(struct aga_build_names* map) {
+	asys_memory_free(map->slots);
+	asys_memory_free(map->names);
+}
+
+/*
+ * An input listed under more than one `Input' entry would otherwise be
+ * Converted by two workers at once into the same artefact. Repeats are
+ * Dropped, and rejected outright where their options disagree.
+ */
+static enum asys_result aga_build_dedupe(struct aga_build_input_pass* pass) {
+	enum asys_result result = ASYS_RESULT_OK;
+
+	struct aga_build_names map;
+	const char** names;
+	asys_size_t i, first, kept = 0;
+
+	if(!pass->count) return ASYS_RESULT_OK;
+
+	if(!(names = asys_memory_allocate(pass->count * sizeof(char*)))) {
+		return ASYS_RESULT_OOM;
+	}
+
+	for(i = 0; i < pass->count; ++i) names[i] = pass->jobs[i].path;
+
+	if((result = aga_build_names_new(&map, names, pass->count))) {
+		asys_memory_free(names);
+		return result;
+	}
+
+	for(i = 0; i < pass->count; ++i) {
+		const struct aga_build_job* job = &pass->jobs[i];
+		const struct aga_build_job* other;
+
+		if((first = aga_build_names_find(&map, job->path)) == i) continue;
+
+		other = &pass->jobs[first];
+
+		if(job->kind != other->kind || job->compress != other->compress ||
+			job->strip != other->strip || job->quantise != other->quantise) {
+
+			asys_log(
+					__FILE__,
+					"err: Input `%s' is listed more than once with differing"
+					" options", job->path);
+
+			result = ASYS_RESULT_BAD_PARAM;
+		}
+	}
+
+	if(result) goto cleanup;
+
+	/* The map only ever compares against first occurrences, which stay. */
+	for(i = 0; i < pass->count; ++i) {
+		struct aga_build_job* job = &pass->jobs[i];
+
+		if(aga_build_names_find(&map, job->path) != i) {
+			asys_memory_free(job->path);
+			continue;
+		}
+
+		pass->jobs[kept++] = *job;
+	}
+
+	pass->count = kept;
+
+	cleanup: {
+		aga_build_names_delete(&map);
+
+		return result;
+	}
+}
+
+static enum asys_result aga_build_input_dir(const char* path, void* pass) {
+	return aga_build_queue(path, pass);
+}
+
+static enum asys_result aga_build_input(
+		const struct aga_input* input, void* pass) {
+
+	struct aga_build_input_pass* input_pass = pass;
+
+	enum asys_result result;
+	union asys_file_attribute attribute;
+
+	input_pass->kind = input->kind;
+	input_pass->compress = input->compress;
+	input_pass->strip = input->strip;
+
+	if(input->strip && input->kind != AGA_KIND_OBJ) {
+		asys_log(
+				__FILE__,
+				"warn: Only inputs of kind `OBJ' can be stripped -- ignoring"
+				" `Strip' for `%s'", input->path);
+
+		input_pass->strip = ASYS_FALSE;
+	}
+
+	input_pass->quantise = input->quantise;
+
+	if(input->quantise && input->kind != AGA_KIND_TIFF) {
+		asys_log(
+				__FILE__,
+				"warn: Only inputs of kind `TIFF' can be quantised -- ignoring"
+				" `Quantise' for `%s'", input->path);
+
+		input_pass->quantise = ASYS_FALSE;
+	}
+
+	/*
+	 * Scripts are handed to the interpreter as a raw pack stream, so always
+	 * Need to be stored as-is.
+	 */
+	if(input->kind == AGA_KIND_PY) {
+		if(input->compress) {
+			asys_log(
+					__FILE__,
+					"warn: Inputs of kind `PY' cannot be compressed -- storing"
+					" `%s' uncompressed", input->path);
+		}
+
+		input_pass->compress = ASYS_FALSE;
+	}
+
+	result = asys_path_attribute(input->path, ASYS_FILE_TYPE, &attribute);
+	if(result) return result;
+
+	if(attribute.type == ASYS_FILE_DIRECTORY) {
+		return asys_path_iterate(
+				input->path, aga_build_input_dir, input->recurse, pass,
+				ASYS_TRUE);
+	}
+	else return aga_build_queue(input->path, input_pass);
+}
+
+static struct aga_build_job* aga_build_take(
+		struct aga_build_input_pass* pass) {
+
+	enum asys_result result;
+
+	struct aga_build_job* job = 0;
+
+	if(pass->threaded) {
+		result = asys_mutex_lock(&pass->lock);
+		if(result) {
+			asys_log_result(__FILE__, "asys_mutex_lock", result);
+			return 0;
+		}
+	}
+
+	if(pass->next < pass->count) job = &pass->jobs[pass->next++];
+
+	if(pass->threaded) {
+		result = asys_mutex_unlock(&pass->lock);
+		asys_log_result(__FILE__, "asys_mutex_unlock", result);
+	}
+
+	return job;
+}
+
+static void aga_build_worker(void* pass) {
+	struct aga_build_input_pass* input_pass = pass;
+	struct aga_build_job* job;
+
+	while((job = aga_build_take(input_pass))) {
+		enum asys_result result;
+		asys_bool_t serial = input_pass->threaded;
+
+		serial = serial && job->kind == AGA_KIND_SGML;
+
+		if(serial && (result = asys_mutex_lock(&input_pass->parse))) {
+			asys_log_result(__FILE__, "asys_mutex_lock", result);
+			job->result = result;
+			continue;
+		}
+
+		job->result = aga_build_input_file(job);
+
+		if(serial) {
+			result = asys_mutex_unlock(&input_pass->parse);
+			asys_log_result(__FILE__, "asys_mutex_unlock", result);
+		}
+	}
+}
+
+/*
+ * NOTE: The calling thread works through the queue alongside the pool, so
+ * 		 Where threads are unavailable everything just happens inline.
+ */
+static enum asys_result aga_build_convert(struct aga_build_input_pass* pass) {
+	enum asys_result result;
+	enum asys_result held_result = ASYS_RESULT_OK;
+
+	struct asys_thread* threads = 0;
+	asys_size_t count = asys_thread_concurrency() - 1;
+	asys_size_t started = 0;
+	asys_size_t i;
+
+	if(count > pass->count) count = pass->count;
+
+	if(count && (result = asys_mutex_new(&pass->lock))) {
+		if(result != ASYS_RESULT_NOT_IMPLEMENTED) {
+			asys_log_result(__FILE__, "asys_mutex_new", result);
+		}
+
+		count = 0;
+	}
+
+	if(count && (result = asys_mutex_new(&pass->parse))) {
+		asys_log_result(__FILE__, "asys_mutex_new", result);
+
+		result = asys_mutex_delete(&pass->lock);
+		asys_log_result(__FILE__, "asys_mutex_delete", result);
+
+		count = 0;
+	}
+
+	if(count) {
+		pass->threaded = ASYS_TRUE;
+
+		threads = asys_memory_allocate(count * sizeof(struct asys_thread));
+		if(!threads) count = 0;
+	}
+
+	/* A pool which comes up short still gets the job done. */
+	for(started = 0; started < count; ++started) {
+		result = asys_thread_new(
+				&threads[started], aga_build_worker, pass);
+
+		if(result) {
+			if(result != ASYS_RESULT_NOT_IMPLEMENTED) {
+				asys_log_result(__FILE__, "asys_thread_new", result);
+			}
+
+			break;
+		}
+	}
+
+	aga_build_worker(pass);
+
+	for(i = 0; i < started; ++i) {
+		result = asys_thread_join(&threads[i]);
+		asys_log_result(__FILE__, "asys_thread_join", result);
+	}
+
+	asys_memory_free(threads);
+
+	if(pass->threaded) {
+		result = asys_mutex_delete(&pass->lock);
+		asys_log_result(__FILE__, "asys_mutex_delete", result);
+
+		result = asys_mutex_delete(&pass->parse);
+		asys_log_result(__FILE__, "asys_mutex_delete", result);
+	}
+
+	for(i = 0; i < pass->count; ++i) {
+		struct aga_build_job* job = &pass->jobs[i];
+
+		if(job->result) {
+			asys_log_result_path(
+					__FILE__, "aga_build_input_file", job->path, job->result);
+
+			if(!held_result) held_result = job->result;
+		}
+	}
+
+	return held_result;
+}
+
+static void aga_build_input_delete(struct aga_build_input_pass* pass) {
+	asys_size_t i;
+
+	for(i = 0; i < pass->count; ++i) asys_memory_free(pass->jobs[i].path);
+
+	asys_memory_free(pass->jobs);
+
+	asys_memory_free(pass->seen);
+
+	if(pass->cached) {
+		asys_log_result(
+				__FILE__, "aga_config_delete", aga_config_delete(&pass->cache));
+	}
+}
+
+/* Yields the path of the file which is stored for a job. */
+static void aga_build_source(
+		const struct aga_build_job* job, asys_fixed_buffer_t* buffer) {
+
+	(*buffer)[0] = 0;
+	asys_string_concatenate(*buffer, job->path);
+
+	/* Use the base file as the input for RAW inputs. */
+	if(job->kind != AGA_KIND_RAW) {
+		asys_string_concatenate(*buffer, AGA_RAW_SUFFIX);
+	}
+}
+
+/*
+ * Adds a job's directory entry. Nothing about the artefact itself is known
+ * Yet -- sizes and tails are filled in as it is packed.
+ */
+static enum asys_result aga_build_conf_file(
+		const struct aga_build_job* job, struct aga_build_conf_pass* pass) {
+
+	asys_fixed_buffer_t buffer = { 0 };
+
+	struct aga_resource_pack_entry* entry;
+	asys_size_t name_length;
+	void* new;
+#ifdef ASYS_WIN32
+	asys_size_t i;
+#endif
+
+	asys_string_concatenate(buffer, job->path);
+
+	/*
+	 * Compiled configs keep the name of their SGML file so that it can be
+	 * Used as-is from scripts.
+	 */
+	if(job->kind != AGA_KIND_SGML && job->kind != AGA_KIND_RAW) {
+		asys_string_concatenate(buffer, AGA_RAW_SUFFIX);
+	}
+
+	name_length = asys_string_length(buffer) + 1;
+
+	new = asys_memory_reallocate(
+			pass->entries,
+			(pass->count + 1) * sizeof(struct aga_resource_pack_entry));
+
+	if(!new) return ASYS_RESULT_OOM;
+	pass->entries = new;
+
+	new = asys_memory_reallocate(
+			pass->strings, pass->strings_size + name_length);
+
+	if(!new) return ASYS_RESULT_OOM;
+	pass->strings = new;
+
+	asys_memory_copy(&pass->strings[pass->strings_size], buffer, name_length);
+
+#ifdef ASYS_WIN32
+	/* TODO: Make a function for this. */
+	for(i = pass->strings_size; pass->strings[i]; ++i) {
+		if(pass->strings[i] == '\\') pass->strings[i] = '/';
+	}
+#endif
 
-	/* TODO: Flag to force rebuilds. */
-	if(older) return ASYS_RESULT_OK;
+	entry = &pass->entries[pass->count];
+	asys_memory_zero(entry, sizeof(struct aga_resource_pack_entry));
 
-	result = asys_stream_new(&in, path);
-	if(result) return result;
+	/*
+	 * Offsets and stored sizes are filled in by the pack pass, which also
+	 * Clears the compression flag again where it does not pay for itself.
+	 */
+	entry->name = (asys_uint_t) pass->strings_size;
+	if(job->compress) entry->flags = AGA_RESOURCE_COMPRESSED;
+	if(job->kind == AGA_KIND_SGML) entry->flags |= AGA_RESOURCE_CONFIG;
 
-	result = asys_stream_new_write(&out, buffer);
-	if(result) goto cleanup;
+	/*
+	 * Version 2 models discarded vertex colouration and version 3 models are
+	 * Indexed -- see `aga_model_header'.
+	 */
+	if(job->kind == AGA_KIND_OBJ) entry->version = AGA_MODEL_INDEXED;
 
-	switch(kind) {
-		default: {
-			asys_log(
-					__FILE__,
-					"err: Unknown or unimplemented input kind for `%s'", path);
+	/* Versioned images carry their mip chain -- see `aga_image_header'. */
+	if(job->kind == AGA_KIND_TIFF) entry->version = AGA_IMAGE_MIPMAPPED;
 
-			goto cleanup;
-		}
+	pass->strings_size += name_length;
+	pass->count++;
 
-		case AGA_KIND_PY: fn = aga_build_python; break;
-		case AGA_KIND_OBJ: fn = aga_build_obj; break;
-		case AGA_KIND_TIFF: fn = aga_build_tiff; break;
+	return ASYS_RESULT_OK;
+}
 
 /*
-		case AGA_KIND_WAV: break;
-		case AGA_KIND_MIDI: break;
+ * Reads the size of an open artefact along with any tail it carries.
+ *
+ * TODO: More formally document these "tails" in a comment at the top of
+ * 		 This file.
  */
-	}
+static enum asys_result aga_build_tail(
+		const struct aga_build_job* job, struct asys_stream* in,
+		struct aga_resource_pack_entry* entry) {
 
-	result = fn(&out, &in);
-	if(result) goto cleanup;
+	enum asys_result result;
 
-	result = asys_stream_delete(&in);
-	if(result) goto cleanup;
+	union asys_file_attribute attribute;
+	asys_size_t tail_size;
+	void* tail;
 
-	return asys_stream_delete(&out);
+	result = asys_stream_attribute(in, ASYS_FILE_LENGTH, &attribute);
+	if(result) return result;
 
-	cleanup: {
-		asys_log_result(
-				__FILE__, "asys_stream_delete", asys_stream_delete(&in));
+	entry->size = (asys_uint_t) attribute.length;
 
-		asys_log_result(
-				__FILE__, "asys_stream_delete", asys_stream_delete(&out));
+	switch(job->kind) {
+		default: return ASYS_RESULT_OK;
 
-		return result;
-	}
-}
+		case AGA_KIND_TIFF: {
+			tail = &entry->width;
+			tail_size = sizeof(aga_image_tail_t);
 
-static enum asys_result aga_build_input_dir(const char* path, void* pass) {
-	enum aga_file_kind* kind = pass;
+			break;
+		}
 
-	return aga_build_input_file(path, *kind);
-}
+		case AGA_KIND_OBJ: {
+			tail = entry->extent;
+			tail_size = sizeof(aga_model_tail_t);
 
-static enum asys_result aga_build_input(
-		const char* path, enum aga_file_kind kind, asys_bool_t recurse,
-		void* pass) {
+			break;
+		}
+	}
 
-	enum asys_result result;
-	union asys_file_attribute attribute;
+	if(entry->size < tail_size) return ASYS_RESULT_BAD_PARAM;
 
-	(void) pass;
+	result = asys_stream_read_at(
+			in, (asys_offset_t) (entry->size - tail_size), 0, tail, tail_size);
 
-	result = asys_path_attribute(path, ASYS_FILE_TYPE, &attribute);
 	if(result) return result;
 
-	if(attribute.type == ASYS_FILE_DIRECTORY) {
-		return asys_path_iterate(
-				path, aga_build_input_dir, recurse, &kind, ASYS_TRUE);
-	}
-	else return aga_build_input_file(path, kind);
+	/* Positional reads may be emulated by seeking, so rewind regardless. */
+	return asys_stream_seek(in, ASYS_SEEK_SET, 0);
 }
 
-static enum asys_result aga_build_conf_file(
-		const char* path, enum aga_file_kind kind, struct asys_stream* stream,
-		asys_size_t* offset) {
-
-	static asys_fixed_buffer_t buffer;
-	static asys_float_format_buffer_t double_format;
-#ifdef ASYS_WIN32
-	static asys_fixed_buffer_t standard_path;
-	asys_size_t i;
-#endif
+/*
+ * Entries which do not shrink under compression are stored as-is, so the flag
+ * Is only ever set where it pays for itself.
+ */
+static enum asys_result aga_build_pack_compressed(
+		struct asys_stream* in, struct asys_stream* stream,
+		struct aga_resource_pack_entry* entry) {
 
 	enum asys_result result;
 
-	union asys_file_attribute attr;
+	void* data;
+	void* compressed = 0;
+	asys_size_t compressed_size;
 
-	/* Skip input files which don't match kind. */
-	if(!aga_build_path_matches_kind(path, kind)) return ASYS_RESULT_OK;
+	if(!(data = asys_memory_allocate(entry->size))) return ASYS_RESULT_OOM;
 
-	buffer[0] = 0;
-	asys_string_concatenate(buffer, path);
+	result = asys_stream_read(in, 0, data, entry->size);
+	if(result) goto cleanup;
 
-	/* Use the base file as the input for SGML/RAW inputs. */
-	if(kind != AGA_KIND_SGML && kind != AGA_KIND_RAW) {
-		asys_string_concatenate(buffer, AGA_RAW_SUFFIX);
-	}
+	result = aga_lz_encode(data, entry->size, &compressed, &compressed_size);
+	if(result) goto cleanup;
 
-#ifdef ASYS_WIN32
-	/* TODO: Make a function for this. */
-	for(i = 0; buffer[i]; ++i) {
-		if(buffer[i] == '\\') standard_path[i] = '/';
-		else standard_path[i] = buffer[i];
-	}
+	if(compressed_size < entry->size) {
+		result = asys_stream_write(stream, compressed, compressed_size);
+		if(result) goto cleanup;
 
-	standard_path[i] = 0;
+		entry->stored = (asys_uint_t) compressed_size;
+		entry->flags |= AGA_RESOURCE_COMPRESSED;
+	}
+	else {
+		result = asys_stream_write(stream, data, entry->size);
+		if(result) goto cleanup;
+	}
 
-	result = aga_fprintf_add(stream, 1, "<item name=\"%s\">\n", standard_path);
-	if(result) return result;
-#else
-	result = aga_fprintf_add(stream, 1, "<item name=\"%s\">\n", buffer);
-	if(result) return result;
-#endif
+	cleanup: {
+		asys_memory_free(compressed);
+		asys_memory_free(data);
 
-	/* Unpleasant but neccesary. */
-#define agab_(indent, name, type, format, parameter) \
-		do { \
-			result = aga_fprintf_add( \
-					stream, indent, \
-					"<item name=\"%s\" type=\"%s\">\n", name, type); \
-			if(result) return result; \
-			\
-			result = aga_fprintf_add( \
-					stream, indent + 1, format "\n", parameter); \
-			if(result) return result; \
-			\
-			result = aga_fprintf_add(stream, indent, "</item>\n"); \
-			if(result) return result; \
-		} while(0)
-
-#define agaf_(indent, name, value) \
-		do { \
-			result = aga_fprintf_add( \
-					stream, indent, \
-					"<item name=\"%s\" type=\"Float\">\n", name); \
-			if(result) return result; \
-			\
-			result = asys_float_to_string(value, &double_format); \
-			if(result) return result; \
-			\
-			result = aga_fprintf_add( \
-					stream, indent + 1, "%s", double_format); \
-			if(result) return result; \
-			\
-			result = aga_fprintf_add(stream, indent, "</item>\n"); \
-			if(result) return result; \
-		} while(0)
+		return result;
+	}
+}
 
-	{
-		agab_(2, "Offset", "Integer", ASYS_NATIVE_ULONG_FORMAT, *offset);
+/*
+ * Writes out entry data in the order given by `layout', which places each
+ * Entry in the pack data independently of its place in the directory. Each
+ * Artefact is opened just the once here -- its size and tail are read from
+ * The same stream as is copied into the pack.
+ */
+static enum asys_result aga_build_pack(
+		struct aga_build_conf_pass* pass, const struct aga_build_job* jobs,
+		struct asys_stream* stream, const asys_size_t* layout) {
 
-		/*
-		 * TODO: If we build as we go we can avoid loads of file open/close
-		 * 		 Operations and entirely eliminate file length gets.
-		 */
-		result = asys_path_attribute(buffer, ASYS_FILE_LENGTH, &attr);
-		if(result) return result;
+	enum asys_result result;
 
-		*offset += attr.length;
-		agab_(2, "Size", "Integer", ASYS_NATIVE_ULONG_FORMAT, attr.length);
+	static const asys_uchar_t padding[AGA_PACK_ALIGN] = { 0 };
 
-		switch(kind) {
-			default: break;
+	asys_fixed_buffer_t buffer;
+	struct asys_stream in;
+	asys_size_t i, pad;
 
-			/*
-			 * TODO: More formally document these "tails" in a comment at the
-			 * 		 Top of this file.
-			 */
-			case AGA_KIND_TIFF: {
-				aga_image_tail_t tail;
+	for(i = 0; i < pass->count; ++i) {
+		const struct aga_build_job* job = &jobs[layout[i]];
+		struct aga_resource_pack_entry* entry = &pass->entries[layout[i]];
 
-				result = asys_path_tail(buffer, &tail, sizeof(tail));
-				if(result) return result;
+		aga_build_source(job, &buffer);
 
-				agab_(2, "Width", "Integer", "%u", tail);
+		if((result = asys_stream_new(&in, buffer))) return result;
 
-				break;
-			}
+		if((result = aga_build_tail(job, &in, entry))) goto cleanup;
 
-			case AGA_KIND_OBJ: {
-				aga_model_tail_t tail;
+		/* Entries are aligned so that mapped data can be used in-place. */
+		if((pad = AGA_PACK_ALIGNED(pass->offset) - pass->offset)) {
+			result = asys_stream_write(stream, padding, pad);
+			if(result) goto cleanup;
 
-				result = asys_path_tail(buffer, tail, sizeof(tail));
-				if(result) return result;
+			pass->offset += pad;
+		}
 
-				agaf_(2, "MinX", tail[0]);
-				agaf_(2, "MinY", tail[1]);
-				agaf_(2, "MinZ", tail[2]);
-				agaf_(2, "MaxX", tail[3]);
-				agaf_(2, "MaxY", tail[4]);
-				agaf_(2, "MaxZ", tail[5]);
+		entry->offset = (asys_uint_t) pass->offset;
+		entry->stored = entry->size;
 
-				/*
-				 * Mark model as version 2 -- we started discarding model
-				 * vertex colouration.
-				 */
-				agab_(2, "Version", "Integer", "%u", 2);
+		if(entry->flags & AGA_RESOURCE_COMPRESSED) {
+			entry->flags &= ~AGA_RESOURCE_COMPRESSED;
 
-				break;
-			}
+			result = aga_build_pack_compressed(&in, stream, entry);
+			if(result) goto cleanup;
+		}
+		else {
+			result = asys_stream_splice(stream, &in, ASYS_COPY_ALL);
+			if(result) goto cleanup;
 		}
-	}
-#undef agab_
 
-	result = aga_fprintf_add(stream, 1, "</item>\n"); \
-	if(result) return result;
+		if((result = asys_stream_delete(&in))) return result;
+
+		pass->offset += entry->stored;
+	}
 
 	return ASYS_RESULT_OK;
-}
 
-static enum asys_result aga_build_conf_dir(const char* path, void* pass) {
-	struct aga_build_conf_pass* conf_pass = pass;
+	cleanup: {
+		asys_log_result(
+				__FILE__, "asys_stream_delete", asys_stream_delete(&in));
 
-	return aga_build_conf_file(
-			path, conf_pass->kind, conf_pass->stream, &conf_pass->offset);
+		return result;
+	}
 }
 
-static enum asys_result aga_build_conf(
-		const char* path, enum aga_file_kind kind, asys_bool_t recurse,
-		void* pass) {
+/*
+ * Marks each entry the trace touches in `seen' -- entries are looked up by
+ * Name through a map built up-front so that this stays linear in the trace.
+ */
+static enum asys_result aga_build_read_trace(
+		const char* path, struct aga_build_conf_pass* pass,
+		asys_size_t* traced, asys_size_t* sizes, asys_bool_t* seen,
+		asys_size_t* traced_count) {
+
+	static const char* trace = "Trace";
+	static const char* size_name = "Size";
 
 	enum asys_result result;
-	union asys_file_attribute attr;
 
-	struct aga_build_conf_pass* conf_pass = pass;
+	struct aga_config_node root;
+	struct aga_config_node* node;
+	struct aga_build_names map;
+	const char** names;
+	asys_size_t i;
+
+	asys_log(__FILE__, "Reading access trace `%s'...", path);
+
+	if((result = aga_build_open_config(path, &root))) return result;
+
+	result = aga_config_lookup_check(root.children, &trace, 1, &node);
+	if(result) {
+		asys_log_result(
+				__FILE__, "aga_config_delete", aga_config_delete(&root));
 
-	if((result = asys_path_attribute(path, ASYS_FILE_TYPE, &attr))) {
 		return result;
 	}
 
-	if(attr.type == ASYS_FILE_DIRECTORY) {
-		conf_pass->kind = kind;
+	if(!(names = asys_memory_allocate((pass->count + 1) * sizeof(char*)))) {
+		asys_log_result(
+				__FILE__, "aga_config_delete", aga_config_delete(&root));
 
-		return asys_path_iterate(
-				path, aga_build_conf_dir, recurse, conf_pass, ASYS_TRUE);
+		return ASYS_RESULT_OOM;
 	}
-	else {
-		return aga_build_conf_file(
-			path, kind, conf_pass->stream, &conf_pass->offset);
+
+	for(i = 0; i < pass->count; ++i) {
+		names[i] = &pass->strings[pass->entries[i].name];
 	}
-}
 
-static enum asys_result aga_build_pack_file(
-		const char* path, enum aga_file_kind kind,
-		struct asys_stream* stream) {
+	if((result = aga_build_names_new(&map, names, pass->count))) {
+		asys_memory_free(names);
+		asys_log_result(
+				__FILE__, "aga_config_delete", aga_config_delete(&root));
+
+		return result;
+	}
 
-	static asys_fixed_buffer_t buffer = { 0 };
+	*traced_count = 0;
 
-	enum asys_result result;
+	for(i = 0; i < node->len; ++i) {
+		struct aga_config_node* child = &node->children[i];
+		aga_config_int_t size;
+		asys_size_t index;
 
-	struct asys_stream in;
+		if(!child->name) continue;
 
-	/* Skip input files which don't match kind. */
-	if(!aga_build_path_matches_kind(path, kind)) return ASYS_RESULT_OK;
+		index = aga_build_names_find(&map, child->name);
+		if(index == pass->count) {
+			asys_log(
+					__FILE__,
+					"warn: Traced resource `%s' is not part of the build",
+					child->name);
 
-	buffer[0] = 0;
+			continue;
+		}
 
-	asys_string_concatenate(buffer, path);
+		if(seen[index]) continue;
+		seen[index] = ASYS_TRUE;
 
-	/* Use the base file as the input for SGML/RAW inputs. */
-	if(kind != AGA_KIND_SGML && kind != AGA_KIND_RAW) {
-		asys_string_concatenate(buffer, AGA_RAW_SUFFIX);
+		result = aga_config_lookup(
+				child, &size_name, 1, &size, AGA_INTEGER, ASYS_FALSE);
+
+		sizes[*traced_count] = result ? AGA_BUILD_UNTRACED : (asys_size_t) size;
+		traced[(*traced_count)++] = index;
 	}
 
-	/* TODO: Should we have a path-wise copy? */
-	result = asys_stream_new(&in, buffer);
-	if(result) return result;
+	aga_build_names_delete(&map);
 
-	result = asys_stream_splice(stream, &in, ASYS_COPY_ALL);
-	if(result) goto cleanup;
+	return aga_config_delete(&root);
+}
 
-	result = asys_stream_delete(&in);
-	if(result) return result;
+static void aga_build_check_trace(
+		struct aga_build_conf_pass* pass, const asys_size_t* traced,
+		const asys_size_t* sizes, asys_size_t traced_count) {
 
-	return ASYS_RESULT_OK;
+	asys_size_t i;
 
-	cleanup: {
-		asys_log_result(
-				__FILE__, "asys_stream_delete", asys_stream_delete(&in));
+	for(i = 0; i < traced_count; ++i) {
+		struct aga_resource_pack_entry* entry = &pass->entries[traced[i]];
 
-		return result;
+		if(sizes[i] == AGA_BUILD_UNTRACED || sizes[i] == entry->size) continue;
+
+		asys_log(
+				__FILE__,
+				"warn: Traced resource `%s' has changed size since the trace"
+				" was taken", &pass->strings[entry->name]);
 	}
 }
 
-static enum asys_result aga_build_pack_dir(const char* path, void* pass) {
-	struct aga_build_conf_pass* conf_pass = pass;
+/*
+ * Sums the distance skipped over between consecutive traced reads, were the
+ * Entries to start at `offsets'.
+ */
+static asys_size_t aga_build_seek_distance(
+		struct aga_build_conf_pass* pass, const asys_size_t* offsets,
+		const asys_size_t* traced, asys_size_t traced_count) {
 
-	return aga_build_pack_file(path, conf_pass->kind, conf_pass->stream);
-}
+	asys_size_t i;
+	asys_size_t position = 0, distance = 0;
 
-static enum asys_result aga_build_pack(
-		const char* path, enum aga_file_kind kind, asys_bool_t recurse,
-		void* pass) {
+	for(i = 0; i < traced_count; ++i) {
+		asys_size_t offset = offsets[traced[i]];
 
-	enum asys_result result;
-	union asys_file_attribute attr;
+		if(offset > position) distance += offset - position;
+		else distance += position - offset;
 
-	if((result = asys_path_attribute(path, ASYS_FILE_TYPE, &attr))) {
-		return result;
+		position = offset + pass->entries[traced[i]].stored;
 	}
 
-	if(attr.type == ASYS_FILE_DIRECTORY) {
-		struct aga_build_conf_pass conf_pass;
+	return distance;
+}
+
+static void aga_build_report_layout(
+		struct aga_build_conf_pass* pass, const asys_size_t* traced,
+		asys_size_t traced_count) {
 
-		conf_pass.stream = pass;
-		conf_pass.kind = kind;
+	asys_size_t* offsets;
+	asys_size_t i, offset = 0;
+	asys_size_t before, after;
 
-		return asys_path_iterate(
-				path, aga_build_pack_dir, recurse, &conf_pass, ASYS_TRUE);
+	offsets = asys_memory_allocate(pass->count * sizeof(asys_size_t));
+	if(!offsets) {
+		asys_log_result(__FILE__, "asys_memory_allocate", ASYS_RESULT_OOM);
+		return;
+	}
+
+	/* The layout without a trace is simply directory order. */
+	for(i = 0; i < pass->count; ++i) {
+		offset = AGA_PACK_ALIGNED(offset);
+		offsets[i] = offset;
+		offset += pass->entries[i].stored;
 	}
-	else return aga_build_pack_file(path, kind, pass);
+
+	before = aga_build_seek_distance(pass, offsets, traced, traced_count);
+
+	for(i = 0; i < pass->count; ++i) offsets[i] = pass->entries[i].offset;
+
+	after = aga_build_seek_distance(pass, offsets, traced, traced_count);
+
+	asys_log(
+			__FILE__,
+			"Traced seek distance is `" ASYS_NATIVE_ULONG_FORMAT "' bytes in"
+			" input order and `" ASYS_NATIVE_ULONG_FORMAT "' bytes as laid"
+			" out", before, after);
+
+	asys_memory_free(offsets);
 }
 
 static enum asys_result aga_build_iter(
@@ -650,9 +2155,14 @@ static enum asys_result aga_build_iter(
 		aga_config_int_t v;
 		const char* str = 0;
 
+		struct aga_input input;
+
 		enum aga_file_kind kind = AGA_KIND_NONE;
 		char* path = 0;
 		asys_bool_t recurse = ASYS_FALSE;
+		asys_bool_t compress = ASYS_FALSE;
+		asys_bool_t strip = ASYS_FALSE;
+		asys_bool_t quantise = ASYS_FALSE;
 
 		for(j = 0; j < node->len; ++j) {
 			struct aga_config_node* child = &node->children[j];
@@ -683,16 +2193,38 @@ static enum asys_result aga_build_iter(
 				recurse = !!v;
 				continue;
 			}
+			else if(aga_config_variable("Compress", child, AGA_INTEGER, &v)) {
+				compress = !!v;
+				continue;
+			}
+			else if(aga_config_variable("Strip", child, AGA_INTEGER, &v)) {
+				strip = !!v;
+				continue;
+			}
+			else if(aga_config_variable("Quantise", child, AGA_INTEGER, &v)) {
+				quantise = !!v;
+				continue;
+			}
 		}
 
 		if(log) {
 			asys_log(
 					__FILE__,
-					"Build Input: Path=\"%s\" Kind=%s Recurse=%s",
-					path, str, recurse ? "True" : "False");
+					"Build Input: Path=\"%s\" Kind=%s Recurse=%s Compress=%s"
+					" Strip=%s Quantise=%s",
+					path, str, recurse ? "True" : "False",
+					compress ? "True" : "False", strip ? "True" : "False",
+					quantise ? "True" : "False");
 		}
 
-		if((result = fn(path, kind, recurse, pass))) {
+		input.path = path;
+		input.kind = kind;
+		input.recurse = recurse;
+		input.compress = compress;
+		input.strip = strip;
+		input.quantise = quantise;
+
+		if((result = fn(&input, pass))) {
 			asys_log_result(
 					__FILE__, "aga_build_iter::<callback>", result);
 
@@ -709,7 +2241,8 @@ static void aga_tiff_handler(
 		asys_bool_t warning, const char* module, const char* format,
 		va_list list) {
 
-	static asys_fixed_buffer_t buffer = { 0 };
+	/* NOTE: This can be reached from any of the input workers. */
+	asys_fixed_buffer_t buffer = { 0 };
 
 	enum asys_result result;
 
@@ -737,6 +2270,61 @@ static void aga_tiff_warning(
 	aga_tiff_handler(ASYS_TRUE, module, format, list);
 }
 
+/*
+ * Converts all inputs which have changed since the last build, as recorded
+ * In the build cache.
+ */
+static enum asys_result aga_build_inputs(
+		struct aga_config_node* root, struct aga_config_node* input_root,
+		struct aga_build_input_pass* pass) {
+
+	static const char* cache = "Cache";
+	static const char* clean = "Clean";
+
+	enum asys_result result;
+
+	char* cache_path = 0;
+	const char* path = AGA_BUILD_CACHE_DEFAULT;
+
+	aga_config_int_t v = 0;
+	asys_bool_t cleaned = ASYS_FALSE;
+
+	result = aga_config_lookup(
+			root->children, &cache, 1, &cache_path, AGA_PATH, ASYS_FALSE);
+
+	if(!result) path = cache_path;
+
+	if((result = aga_build_cache_open(path, pass))) goto cleanup;
+
+	result = aga_build_iter(input_root, ASYS_TRUE, aga_build_input, pass);
+	if(result) goto cleanup;
+
+	if((result = aga_build_dedupe(pass))) goto cleanup;
+
+	result = aga_build_convert(pass);
+
+	if(!result && pass->cached) {
+		enum asys_result lookup = aga_config_lookup(
+				root->children, &clean, 1, &v, AGA_INTEGER, ASYS_FALSE);
+
+		if(!lookup && v) {
+			aga_build_cache_clean(pass);
+			cleaned = ASYS_TRUE;
+		}
+	}
+
+	/* Whatever did convert is worth remembering even if the build fails. */
+	asys_log_result(
+			__FILE__, "aga_build_cache_write",
+			aga_build_cache_write(path, pass, cleaned));
+
+	cleanup: {
+		asys_memory_free(cache_path);
+
+		return result;
+	}
+}
+
 /* TODO: Lots of leaky error states in here and the above statics. */
 /*
  * TODO: Extra verbose per-file output if set to verbose output. Make
@@ -745,6 +2333,7 @@ static void aga_tiff_warning(
  */
 enum asys_result aga_build(struct aga_settings* opts) {
 	static const char* input = "Input";
+	static const char* trace = "Trace";
 
 	enum asys_result result;
 
@@ -754,6 +2343,16 @@ enum asys_result aga_build(struct aga_settings* opts) {
 	struct asys_stream stream = { 0 };
 	char* out_path = 0;
 
+	struct aga_build_input_pass input_pass = { 0 };
+	struct aga_build_conf_pass conf_pass = { 0 };
+
+	char* trace_path = 0;
+	asys_size_t* traced = 0;
+	asys_size_t* sizes = 0;
+	asys_size_t* layout = 0;
+	asys_bool_t* seen = 0;
+	asys_size_t traced_count = 0;
+
 	asys_log(__FILE__, "Compiling project `%s'...", opts->build_file);
 
 	TIFFSetErrorHandler(aga_tiff_error);
@@ -769,9 +2368,8 @@ enum asys_result aga_build(struct aga_settings* opts) {
 		goto cleanup;
 	}
 
-	if((result = aga_build_iter(input_root, ASYS_TRUE, aga_build_input, 0))) {
-		goto cleanup;
-	}
+	result = aga_build_inputs(&root, input_root, &input_pass);
+	if(result) goto cleanup;
 
 	result = aga_build_open_output(&root, &stream, &out_path);
 	if(result) goto cleanup;
@@ -779,57 +2377,141 @@ enum asys_result aga_build(struct aga_settings* opts) {
 	asys_log(__FILE__, "Building pack directory...");
 
 	{
-		struct aga_build_conf_pass conf_pass;
+		asys_size_t i;
+
+		for(i = 0; i < input_pass.count; ++i) {
+			result = aga_build_conf_file(&input_pass.jobs[i], &conf_pass);
+			if(result) goto cleanup;
+		}
+	}
+
+	{
+		static const asys_uchar_t padding[AGA_PACK_ALIGN] = { 0 };
+
+		struct aga_resource_pack_header header = { 0, AGA_PACK_BINARY_MAGIC };
+		asys_uint_t count = (asys_uint_t) conf_pass.count;
+		asys_size_t table_size, size, pad;
 
-		struct aga_resource_pack_header header = { 0, AGA_PACK_MAGIC };
-		asys_offset_t offset;
+		table_size = conf_pass.count * sizeof(struct aga_resource_pack_entry);
 
-		conf_pass.stream = &stream;
-		conf_pass.offset = 0;
+		/* The directory is padded so that resource data starts aligned. */
+		size = sizeof(header) + sizeof(count) + table_size;
+		size += conf_pass.strings_size;
+		pad = AGA_PACK_ALIGNED(size) - size;
+
+		header.size = (asys_uint_t) (size + pad - sizeof(header));
 
 		result = asys_stream_write(
 				&stream, &header, sizeof(struct aga_resource_pack_header));
 
 		if(result) goto cleanup;
 
-		/* TODO: CLI option to emit this separately for inspection. */
-		result = asys_stream_write_format(&stream, "<root>\n");
+		result = asys_stream_write(&stream, &count, sizeof(count));
 		if(result) goto cleanup;
 
-		result = aga_build_iter(
-				input_root, ASYS_FALSE, aga_build_conf, &conf_pass);
-
+		result = asys_stream_write(&stream, conf_pass.entries, table_size);
 		if(result) goto cleanup;
 
-		result = asys_stream_write_format(&stream, "</root>\n");
+		result = asys_stream_write(
+				&stream, conf_pass.strings, conf_pass.strings_size);
+
 		if(result) goto cleanup;
 
-		result = asys_stream_tell(&stream, &offset);
+		result = asys_stream_write(&stream, padding, pad);
 		if(result) goto cleanup;
+	}
 
-		header.size =
-			(asys_uint_t) offset - sizeof(struct aga_resource_pack_header);
+	{
+		asys_size_t i, laid_out;
 
-		result = asys_stream_seek(&stream, ASYS_SEEK_SET, 0);
-		if(result) goto cleanup;
+		traced = asys_memory_allocate_zero(
+				conf_pass.count + 1, sizeof(asys_size_t));
 
-		result = asys_stream_write(
-				&stream, &header, sizeof(struct aga_resource_pack_header));
+		sizes = asys_memory_allocate_zero(
+				conf_pass.count + 1, sizeof(asys_size_t));
 
-		if(result) goto cleanup;
+		layout = asys_memory_allocate_zero(
+				conf_pass.count + 1, sizeof(asys_size_t));
 
-		result = asys_stream_seek(&stream, ASYS_SEEK_SET, offset);
-		if(result) goto cleanup;
+		seen = asys_memory_allocate_zero(
+				conf_pass.count + 1, sizeof(asys_bool_t));
+
+		if(!traced || !sizes || !layout || !seen) {
+			result = ASYS_RESULT_OOM;
+			goto cleanup;
+		}
+
+		result = aga_config_lookup(
+				root.children, &trace, 1, &trace_path, AGA_PATH, ASYS_FALSE);
+
+		if(!result) {
+			result = aga_build_read_trace(
+					trace_path, &conf_pass, traced, sizes, seen, &traced_count);
+
+			if(result) goto cleanup;
+		}
+
+		/*
+		 * Resources are laid out in the order the trace first touched them,
+		 * Followed by anything untraced in input order.
+		 */
+		for(i = 0; i < traced_count; ++i) layout[i] = traced[i];
+		laid_out = traced_count;
+
+		for(i = 0; i < conf_pass.count; ++i) {
+			if(!seen[i]) layout[laid_out++] = i;
+		}
 	}
 
 	asys_log(__FILE__, "Inserting file data...");
 
-	result = aga_build_iter(input_root, ASYS_FALSE, aga_build_pack, &stream);
+	result = aga_build_pack(&conf_pass, input_pass.jobs, &stream, layout);
 	if(result) goto cleanup;
 
+	/* Patch the directory now that stored offsets and sizes are known. */
+	{
+		asys_offset_t offset = sizeof(struct aga_resource_pack_header);
+		asys_size_t table_size;
+		asys_size_t i, size = 0;
+
+		offset += sizeof(asys_uint_t);
+		table_size = conf_pass.count * sizeof(struct aga_resource_pack_entry);
+
+		result = asys_stream_seek(&stream, ASYS_SEEK_SET, offset);
+		if(result) goto cleanup;
+
+		result = asys_stream_write(&stream, conf_pass.entries, table_size);
+		if(result) goto cleanup;
+
+		for(i = 0; i < conf_pass.count; ++i) {
+			size += conf_pass.entries[i].size;
+		}
+
+		asys_log(
+				__FILE__,
+				"Stored `" ASYS_NATIVE_ULONG_FORMAT "' bytes of resource data"
+				" in `" ASYS_NATIVE_ULONG_FORMAT "' bytes",
+				size, conf_pass.offset);
+	}
+
+	if(traced_count) {
+		aga_build_check_trace(&conf_pass, traced, sizes, traced_count);
+		aga_build_report_layout(&conf_pass, traced, traced_count);
+	}
+
 	result = asys_stream_delete(&stream);
 	if(result) goto cleanup;
 
+	aga_build_input_delete(&input_pass);
+
+	asys_memory_free(conf_pass.entries);
+	asys_memory_free(conf_pass.strings);
+	asys_memory_free(traced);
+	asys_memory_free(sizes);
+	asys_memory_free(layout);
+	asys_memory_free(seen);
+	asys_memory_free(trace_path);
+
 	if((result = aga_config_delete(&root))) return result;
 
 	asys_memory_free(out_path);
@@ -859,6 +2541,16 @@ enum asys_result aga_build(struct aga_settings* opts) {
 
 		asys_memory_free(out_path);
 
+		aga_build_input_delete(&input_pass);
+
+		asys_memory_free(conf_pass.entries);
+		asys_memory_free(conf_pass.strings);
+		asys_memory_free(traced);
+		asys_memory_free(sizes);
+		asys_memory_free(layout);
+		asys_memory_free(seen);
+		asys_memory_free(trace_path);
+
 		asys_log(__FILE__, "err: Build failed");
 
 		return result;
@@ -26,15 +26,64 @@ enum aga_sgml_item_attribute {
 };
 
 #define AGA_CONFIG_MAX_DEPTH (1024)
+#define AGA_CONFIG_STACK_MIN (16)
+
+/* Input is handed to the SGML parser in blocks of this size. */
+#define AGA_CONFIG_BLOCK (4096)
+
+/*
+ * Node text starts out at this size and doubles whenever it fills, so
+ * Strings only need reallocating a handful of times as they grow. Children
+ * Arrays grow in the same way.
+ */
+#define AGA_CONFIG_STRING_MIN (16)
+#define AGA_CONFIG_CHILDREN_MIN (4)
+
+/*
+ * Arena blocks are at least this large -- anything bigger than a quarter of
+ * A block gets a block of its own.
+ */
+#define AGA_CONFIG_ARENA_BLOCK (16384)
+
+union aga_config_align {
+	void* pointer;
+	double flt;
+	aga_config_int_t integer;
+};
+
+#define AGA_CONFIG_ALIGN(size) \
+		(((size) + sizeof(union aga_config_align) - 1) / \
+		sizeof(union aga_config_align) * sizeof(union aga_config_align))
+
+/*
+ * Nodes with at least this many children get a child index when they are
+ * Closed. Tables are kept at most half full.
+ */
+#define AGA_CONFIG_INDEX_MIN (8)
+
+#define AGA_CONFIG_BLOCK_DATA(block) \
+		((asys_uchar_t*) (block) + \
+		AGA_CONFIG_ALIGN(sizeof(struct aga_config_block)))
 
 #define AGA_CONFIG_INTEGER_DEFAULT (ASYS_MAKE_NATIVE_LONG(0))
 #define AGA_CONFIG_FLOAT_DEFAULT (0.0)
 
+/*
+ * Parser state is per-call so that configs may be parsed concurrently (i.e.
+ * From worker threads) -- the SGML class and DTD below are read-only.
+ * NOTE: libwww's own SGML parser has yet to be audited for shared state, so
+ * 		 Callers still serialise parsing for now (see `aga_build_convert').
+ */
 struct aga_sgml_structured {
 	const HTStructuredClass* class;
 
-	struct aga_config_node* stack[1024];
+	/* Grows on demand up to `AGA_CONFIG_MAX_DEPTH'. */
+	struct aga_config_node** stack;
 	asys_size_t depth;
+	asys_size_t capacity;
+
+	/* The arena of the tree being parsed. */
+	struct aga_config_block** arena;
 };
 
 void SGML_character(HTStream*, char);
@@ -99,11 +148,147 @@ static HTStructuredClass aga_global_sgml_class[1] = {
 		}
 };
 
-static struct aga_sgml_structured aga_global_sgml_structured = {
-		aga_global_sgml_class,
-		{ 0 },
-		0
-};
+static void* aga_config_allocate(
+		struct aga_config_block** arena, asys_size_t size) {
+
+	struct aga_config_block* block = *arena;
+	void* data;
+
+	size = AGA_CONFIG_ALIGN(size);
+
+	if(!block || block->size - block->used < size) {
+		struct aga_config_block* new;
+		asys_size_t block_size = AGA_CONFIG_ARENA_BLOCK;
+		asys_bool_t own = size > AGA_CONFIG_ARENA_BLOCK / 4;
+
+		if(own) block_size = size;
+
+		new = asys_memory_allocate(
+				AGA_CONFIG_ALIGN(sizeof(struct aga_config_block)) +
+				block_size);
+
+		if(!new) return 0;
+
+		new->size = block_size;
+		new->used = 0;
+
+		/*
+		 * Large allocations are chained in behind the current block so that
+		 * Its remaining space is not abandoned.
+		 */
+		if(own && block) {
+			new->next = block->next;
+			block->next = new;
+		}
+		else {
+			new->next = block;
+			*arena = new;
+		}
+
+		block = new;
+	}
+
+	data = AGA_CONFIG_BLOCK_DATA(block) + block->used;
+	block->used += size;
+
+	return data;
+}
+
+/*
+ * Grows an arena allocation. The most recent allocation in the current block
+ * Is extended in place where there is room (the common case when a node's
+ * Text is accumulated), otherwise the data is moved and the old space is
+ * Left until the tree is deleted.
+ */
+static void* aga_config_reallocate(
+		struct aga_config_block** arena, void* data, asys_size_t old_size,
+		asys_size_t new_size) {
+
+	struct aga_config_block* block = *arena;
+	void* new;
+
+	if(data && block) {
+		asys_uchar_t* top = AGA_CONFIG_BLOCK_DATA(block) + block->used;
+		asys_size_t old_aligned = AGA_CONFIG_ALIGN(old_size);
+		asys_size_t new_aligned = AGA_CONFIG_ALIGN(new_size);
+
+		if((asys_uchar_t*) data + old_aligned == top &&
+			block->size - (block->used - old_aligned) >= new_aligned) {
+
+			block->used = block->used - old_aligned + new_aligned;
+
+			return data;
+		}
+	}
+
+	if(!(new = aga_config_allocate(arena, new_size))) return 0;
+	if(data) asys_memory_copy(new, data, old_size);
+
+	return new;
+}
+
+static asys_size_t aga_config_hash(const char* string) {
+	/* FNV-1a. */
+	asys_size_t hash = 2166136261UL;
+
+	while(*string) {
+		hash ^= (asys_uchar_t) *string++;
+		hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+	}
+
+	return hash;
+}
+
+static asys_size_t aga_config_index_size(asys_size_t len) {
+	asys_size_t size = 1;
+
+	while(size < len * 2) size <<= 1;
+
+	return size;
+}
+
+/*
+ * NOTE: Indices are built with linear probing and never removed from, so
+ * 		 Probing from a name's slot meets its duplicates in document order --
+ * 		 Lookups keep the "first match wins" semantics of a linear scan.
+ */
+static void aga_config_index(
+		struct aga_config_block** arena, struct aga_config_node* node) {
+
+	asys_size_t i, size, mask;
+
+	size = aga_config_index_size(node->len);
+	mask = size - 1;
+
+	node->index = aga_config_allocate(arena, size * sizeof(asys_uint_t));
+	if(!node->index) return;
+
+	asys_memory_zero(node->index, size * sizeof(asys_uint_t));
+
+	for(i = 0; i < node->len; ++i) {
+		const char* name = node->children[i].name;
+		asys_size_t slot;
+
+		if(!name) continue;
+
+		slot = aga_config_hash(name) & mask;
+		while(node->index[slot]) slot = (slot + 1) & mask;
+
+		node->index[slot] = (asys_uint_t) (i + 1);
+	}
+}
+
+static char* aga_config_duplicate(
+		struct aga_config_block** arena, const char* string) {
+
+	asys_size_t size = asys_string_length(string) + 1;
+	char* new;
+
+	if(!(new = aga_config_allocate(arena, size))) return 0;
+	asys_memory_copy(new, string, size);
+
+	return new;
+}
 
 static enum asys_result aga_sgml_push(
 		struct aga_sgml_structured* s, struct aga_config_node* node) {
@@ -111,7 +296,22 @@ static enum asys_result aga_sgml_push(
 	if(!s) return ASYS_RESULT_BAD_PARAM;
 	if(!node) return ASYS_RESULT_BAD_PARAM;
 
-	if(s->depth > AGA_CONFIG_MAX_DEPTH) return ASYS_RESULT_OOM;
+	if(s->depth >= AGA_CONFIG_MAX_DEPTH) return ASYS_RESULT_OOM;
+
+	if(s->depth == s->capacity) {
+		asys_size_t capacity = s->capacity * 2;
+		void* new;
+
+		if(!capacity) capacity = AGA_CONFIG_STACK_MIN;
+
+		new = asys_memory_reallocate(
+				s->stack, capacity * sizeof(struct aga_config_node*));
+
+		if(!new) return ASYS_RESULT_OOM;
+
+		s->stack = new;
+		s->capacity = capacity;
+	}
 
 	s->stack[s->depth++] = node;
 
@@ -134,6 +334,7 @@ static void aga_sgml_abort(struct aga_sgml_structured* me, HTError e) {
 
 static void aga_sgml_put_character(struct aga_sgml_structured* me, char c) {
 	struct aga_config_node* node;
+	asys_size_t used;
 
 	if(!me->depth) {
 		asys_log(
@@ -151,12 +352,27 @@ static void aga_sgml_put_character(struct aga_sgml_structured* me, char c) {
 	if(node->type == AGA_NONE) return;
 	if(!node->data.string && asys_character_is_blank(c)) return;
 
-	node->data.string = asys_memory_reallocate_safe(
-			node->data.string, ++node->scratch + 1);
+	/*
+	 * `scratch' holds the string length, and the capacity follows from it --
+	 * The buffer is exactly full whenever the bytes in use (including the
+	 * Terminator) land on a power of two.
+	 */
+	used = node->scratch + 1;
+
+	if(!node->data.string) {
+		node->data.string = aga_config_allocate(
+				me->arena, AGA_CONFIG_STRING_MIN);
+
+		node->scratch = 0;
+	}
+	else if(used >= AGA_CONFIG_STRING_MIN && !(used & (used - 1))) {
+		node->data.string = aga_config_reallocate(
+				me->arena, node->data.string, used, used * 2);
+	}
 
 	if(!node->data.string) return;
 
-	node->data.string[node->scratch - 1] = c;
+	node->data.string[node->scratch++] = c;
 	node->data.string[node->scratch] = 0;
 }
 
@@ -179,7 +395,7 @@ static void aga_sgml_start_element(
 	struct aga_config_node* node;
 	enum asys_result result;
 
-	asys_size_t sz;
+	asys_size_t len;
 
 	if(!me->depth) {
 		asys_log(
@@ -191,19 +407,31 @@ static void aga_sgml_start_element(
 	}
 
 	parent = me->stack[me->depth - 1];
-	sz = ++parent->len * sizeof(struct aga_config_node);
+	len = parent->len;
 
 	/*asys_log(
 			__FILE__, "aga_sgml_start_element: %d -> %s",
 			element_number, aga_global_sgml_tags[element_number].name);*/
 
-	parent->children = asys_memory_reallocate_safe(parent->children, sz);
+	/* As with node text -- the array is full when `len' is a power of two. */
+	if(!len) {
+		parent->children = aga_config_allocate(
+				me->arena,
+				AGA_CONFIG_CHILDREN_MIN * sizeof(struct aga_config_node));
+	}
+	else if(len >= AGA_CONFIG_CHILDREN_MIN && !(len & (len - 1))) {
+		parent->children = aga_config_reallocate(
+				me->arena, parent->children,
+				len * sizeof(struct aga_config_node),
+				len * 2 * sizeof(struct aga_config_node));
+	}
+
 	if(!parent->children) {
 		parent->len = 0;
 		return;
 	}
 
-	node = &parent->children[parent->len - 1];
+	node = &parent->children[parent->len++];
 	asys_memory_zero(node, sizeof(struct aga_config_node));
 
 	if((result = aga_sgml_push(me, node))) {
@@ -224,7 +452,8 @@ static void aga_sgml_start_element(
 			else {
 				const char* value = attribute_value[AGA_ITEM_NAME];
 				/* TODO: Clear new alloc on OOM (?). */
-				if(!(node->name = asys_string_duplicate(value))) return;
+				node->name = aga_config_duplicate(me->arena, value);
+				if(!node->name) return;
 			}
 
 			if(!attribute_present[AGA_ITEM_TYPE]) node->type = AGA_NONE;
@@ -305,7 +534,6 @@ static void aga_sgml_end_element(
 			}
 
 			res = asys_string_to_native_long(node->data.string, 0);
-			asys_memory_free(string);
 			node->data.integer = res;
 
 			break;
@@ -325,13 +553,14 @@ static void aga_sgml_end_element(
 			}
 
 			res = asys_string_to_double(node->data.string, 0);
-			asys_memory_free(string);
 			node->data.flt = res;
 
 			break;
 		}
 	}
 
+	if(node->len >= AGA_CONFIG_INDEX_MIN) aga_config_index(me->arena, node);
+
 	me->depth--;
 
 	/*asys_log(
@@ -350,6 +579,39 @@ void HTOOM(const char* file, const char* func) {
 	asys_result_fatal(file, func, ASYS_RESULT_OOM);
 }
 
+static enum asys_result aga_config_begin(
+		struct aga_sgml_structured* structured, struct aga_config_node* root,
+		HTStream** s) {
+
+	enum asys_result result;
+
+	asys_memory_zero(root, sizeof(struct aga_config_node));
+	asys_memory_zero(structured, sizeof(struct aga_sgml_structured));
+
+	structured->class = aga_global_sgml_class;
+	structured->arena = &root->data.arena;
+
+	if((result = aga_sgml_push(structured, root))) return result;
+
+	*s = SGML_new(&aga_global_sgml_dtd, (void*) structured);
+
+	return ASYS_RESULT_OK;
+}
+
+static void aga_config_end(
+		struct aga_sgml_structured* structured, HTStream* s) {
+
+	SGML_free(s);
+
+	asys_memory_free(structured->stack);
+}
+
+static void aga_config_put(HTStream* s, const char* data, asys_size_t count) {
+	asys_size_t i;
+
+	for(i = 0; i < count; ++i) SGML_character(s, data[i]);
+}
+
 /*
  * TODO: Derive when to end the stream when the `<root>' element closes instead
  * 		 Of needing to provide a `count'? Lets `aga_build' skip a few `stat's.
@@ -360,8 +622,9 @@ enum asys_result aga_config_new(
 
 	enum asys_result result;
 
+	struct aga_sgml_structured structured;
 	HTStream* s;
-	asys_size_t i;
+	char block[AGA_CONFIG_BLOCK];
 
 #if !defined(AGA_DEVBUILD) && !defined(NDEBUG)
 	if(count == AGA_CONFIG_EOF) {
@@ -370,54 +633,280 @@ enum asys_result aga_config_new(
 	}
 #endif
 
+	result = aga_config_begin(&structured, root, &s);
+	if(result) {
+		asys_memory_free(structured.stack);
+		return result;
+	}
+
+	/*
+	 * NOTE: Reads never go past `count' so the stream is left just after the
+	 * 		 Config, as the pack and script loaders expect.
+	 */
+	while(count) {
+		asys_size_t request = sizeof(block);
+		asys_size_t read_count;
+
+		if(count < request) request = count;
+
+		result = asys_stream_read(stream, &read_count, block, request);
+		if(result && result != ASYS_RESULT_EOF) {
+			aga_config_end(&structured, s);
+			return result;
+		}
+
+		aga_config_put(s, block, read_count);
+
+		if(result == ASYS_RESULT_EOF || !read_count) break;
+
+		count -= read_count;
+	}
+
+	aga_config_end(&structured, s);
+
+	return ASYS_RESULT_OK;
+}
+
+static asys_bool_t aga_config_is_binary(
+		const void* data, asys_size_t count) {
+
+	const char* magic = AGA_CONFIG_BINARY_MAGIC;
+	const char* bytes = data;
+	asys_size_t i;
+
+	if(count < sizeof(struct aga_config_binary_header)) return ASYS_FALSE;
+
+	for(i = 0; i < 4; ++i) if(bytes[i] != magic[i]) return ASYS_FALSE;
+
+	return ASYS_TRUE;
+}
+
+static asys_bool_t aga_config_check_binary(
+		const struct aga_config_binary_header* header,
+		const asys_uchar_t* records,
+		const struct aga_config_binary_node* record, asys_size_t i,
+		const asys_uint_t* index) {
+
+	asys_size_t j, size;
+	asys_bool_t empty = ASYS_FALSE;
+
+	if(record->name > header->strings_size) return ASYS_FALSE;
+	if(record->string > header->strings_size) return ASYS_FALSE;
+	if(record->type > AGA_FLOAT) return ASYS_FALSE;
+
+	if(record->len) {
+		/* Children always come after their parent -- this rules out loops. */
+		if(record->children <= i) return ASYS_FALSE;
+		if(record->children > header->count) return ASYS_FALSE;
+		if(record->len > header->count - record->children) return ASYS_FALSE;
+	}
+
+	if(record->index) {
+		size = aga_config_index_size(record->len);
+
+		if(record->index - 1 > header->index_size) return ASYS_FALSE;
+		if(size > header->index_size - (record->index - 1)) return ASYS_FALSE;
+
+		/*
+		 * Lookups probe until they reach an empty slot and compare names
+		 * Along the way -- so a full table or a nameless target would have
+		 * Them spin forever or compare against null.
+		 */
+		for(j = 0; j < size; ++j) {
+			struct aga_config_binary_node target;
+			asys_uint_t entry = index[record->index - 1 + j];
+
+			if(!entry) {
+				empty = ASYS_TRUE;
+				continue;
+			}
+
+			if(entry > record->len) return ASYS_FALSE;
+
+			asys_memory_copy(
+					&target, records + (record->children + entry - 1) *
+					sizeof(target), sizeof(target));
+
+			if(!target.name) return ASYS_FALSE;
+		}
+
+		if(!empty) return ASYS_FALSE;
+	}
+
+	return ASYS_TRUE;
+}
+
+/*
+ * Node records are copied out as pack data need not be aligned -- the single
+ * Arena allocation holds the nodes, the index tables and (if `copy' is set)
+ * The strings.
+ */
+static enum asys_result aga_config_load(
+		const void* data, asys_size_t count, struct aga_config_node* root,
+		asys_bool_t copy) {
+
+	const asys_uchar_t* bytes = data;
+
+	struct aga_config_binary_header header;
+	struct aga_config_block* arena;
+	struct aga_config_node* nodes;
+	asys_uint_t* index;
+	const char* strings;
+
+	asys_size_t i, size;
+	asys_size_t nodes_size, index_size;
+
+	asys_memory_copy(&header, bytes, sizeof(header));
+	bytes += sizeof(header);
+	count -= sizeof(header);
+
+	nodes_size = header.count * sizeof(struct aga_config_binary_node);
+	index_size = header.index_size * sizeof(asys_uint_t);
+
+	if(!header.count || nodes_size > count ||
+		index_size > count - nodes_size ||
+		header.strings_size != count - nodes_size - index_size ||
+		(header.strings_size && bytes[count - 1])) {
+
+		asys_log(__FILE__, "err: Malformed compiled config");
+		return ASYS_RESULT_BAD_PARAM;
+	}
+
 	asys_memory_zero(root, sizeof(struct aga_config_node));
 
-	result = aga_sgml_push(&aga_global_sgml_structured, root);
-	if(result) return result;
+	size = header.count * sizeof(struct aga_config_node) + index_size;
+	if(copy) size += header.strings_size;
 
-	s = SGML_new(&aga_global_sgml_dtd, (void*) &aga_global_sgml_structured);
+	nodes = aga_config_allocate(&root->data.arena, size);
+	if(!nodes) return ASYS_RESULT_OOM;
 
-	for(i = 0; i < count; ++i) {
-		char c;
+	index = (asys_uint_t*) &nodes[header.count];
+	asys_memory_copy(index, bytes + nodes_size, index_size);
 
-		if((result = asys_stream_read(stream, 0, &c, 1))) {
-			if(result == ASYS_RESULT_EOF) break;
+	strings = (const char*) bytes + nodes_size + index_size;
+	if(copy) {
+		char* copied = (char*) index + index_size;
 
-			SGML_free(s);
-			return result;
+		asys_memory_copy(copied, strings, header.strings_size);
+		strings = copied;
+	}
+
+	for(i = 0; i < header.count; ++i) {
+		struct aga_config_binary_node record;
+		struct aga_config_node* node = &nodes[i];
+
+		asys_memory_copy(&record, bytes + i * sizeof(record), sizeof(record));
+
+		if(!aga_config_check_binary(&header, bytes, &record, i, index)) {
+			asys_log(__FILE__, "err: Malformed compiled config node");
+			aga_config_delete(root);
+
+			return ASYS_RESULT_BAD_PARAM;
 		}
 
-		SGML_character(s, (char) c);
+		node->name = record.name ? (char*) &strings[record.name - 1] : 0;
+		node->type = (enum aga_config_node_type) record.type;
+		node->scratch = 0;
+		node->children = record.len ? &nodes[record.children] : 0;
+		node->len = record.len;
+		node->index = record.index ? &index[record.index - 1] : 0;
+
+		switch(node->type) {
+			default: {
+				node->data.string = 0;
+				break;
+			}
+			case AGA_STRING: {
+				const char* string = &strings[record.string - 1];
+
+				node->data.string = record.string ? (char*) string : 0;
+				break;
+			}
+			case AGA_INTEGER: {
+				node->data.integer = (aga_config_int_t) record.value;
+				break;
+			}
+			case AGA_FLOAT: {
+				node->data.flt = record.value;
+				break;
+			}
+		}
 	}
 
-	SGML_free(s);
+	/* The first record is the tree root itself. */
+	arena = root->data.arena;
+	*root = nodes[0];
+	root->data.arena = arena;
 
 	return ASYS_RESULT_OK;
 }
 
-void aga_free_node(struct aga_config_node* node) {
-	asys_size_t i;
+enum asys_result aga_config_new_memory(
+		const void* data, asys_size_t count, struct aga_config_node* root) {
 
-	if(!node) return;
+	enum asys_result result;
 
-	for(i = 0; i < node->len; ++i) {
-		aga_free_node(&node->children[i]);
+	struct aga_sgml_structured structured;
+	HTStream* s;
+
+	if(!data) return ASYS_RESULT_BAD_PARAM;
+	if(!root) return ASYS_RESULT_BAD_PARAM;
+
+	if(aga_config_is_binary(data, count)) {
+		return aga_config_load(data, count, root, ASYS_TRUE);
+	}
+
+	result = aga_config_begin(&structured, root, &s);
+	if(result) {
+		asys_memory_free(structured.stack);
+		return result;
 	}
 
-	if(node->type == AGA_STRING) asys_memory_free(node->data.string);
+	aga_config_put(s, data, count);
 
-	asys_memory_free(node->name);
-	asys_memory_free(node->children);
+	aga_config_end(&structured, s);
+
+	return ASYS_RESULT_OK;
+}
+
+enum asys_result aga_config_view(
+		const void* data, asys_size_t count, struct aga_config_node* root) {
+
+	if(!data) return ASYS_RESULT_BAD_PARAM;
+	if(!root) return ASYS_RESULT_BAD_PARAM;
+
+	if(aga_config_is_binary(data, count)) {
+		return aga_config_load(data, count, root, ASYS_FALSE);
+	}
+
+	return aga_config_new_memory(data, count, root);
 }
 
 enum asys_result aga_config_delete(struct aga_config_node* root) {
+	struct aga_config_block* block;
+
 	if(!root) return ASYS_RESULT_BAD_PARAM;
 
-	aga_free_node(root);
+	block = root->data.arena;
+	while(block) {
+		struct aga_config_block* next = block->next;
+
+		asys_memory_free(block);
+		block = next;
+	}
+
+	asys_memory_zero(root, sizeof(struct aga_config_node));
 
 	return ASYS_RESULT_OK;
 }
 
+char* aga_config_string(struct aga_config_node* root, const char* string) {
+	if(!root) return 0;
+	if(!string) return 0;
+
+	return aga_config_duplicate(&root->data.arena, string);
+}
+
 asys_bool_t aga_config_variable(
 		const char* name, struct aga_config_node* node,
 		enum aga_config_node_type type, void* value) {
@@ -493,6 +982,28 @@ enum asys_result aga_config_lookup_raw(
 		return ASYS_RESULT_OK;
 	}
 
+	if(root->index) {
+		asys_size_t mask = aga_config_index_size(root->len) - 1;
+		asys_size_t slot = aga_config_hash(*names) & mask;
+
+		while(root->index[slot]) {
+			struct aga_config_node* node;
+
+			node = &root->children[root->index[slot] - 1];
+
+			if(node->name && asys_string_equal(*names, node->name)) {
+				enum asys_result result = aga_config_lookup_raw(
+						node, names + 1, count - 1, out);
+
+				if(!result) return result;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+
+		return ASYS_RESULT_MISSING_KEY;
+	}
+
 	for(i = 0; i < root->len; ++i) {
 		struct aga_config_node* node = &root->children[i];
 
@@ -541,6 +1052,86 @@ enum asys_result aga_config_lookup(
 	else return ASYS_RESULT_BAD_TYPE;
 }
 
+static asys_bool_t aga_config_same_parent(
+		const struct aga_config_query* a, const struct aga_config_query* b) {
+
+	asys_size_t i;
+
+	if(a->count != b->count) return ASYS_FALSE;
+
+	for(i = 0; i + 1 < a->count; ++i) {
+		if(a->names[i] == b->names[i]) continue;
+		if(!asys_string_equal(a->names[i], b->names[i])) return ASYS_FALSE;
+	}
+
+	return ASYS_TRUE;
+}
+
+enum asys_result aga_config_lookup_all(
+		struct aga_config_node* root, struct aga_config_query* queries,
+		asys_size_t count) {
+
+	struct aga_config_node* parent = 0;
+	asys_size_t i;
+
+	if(!root) return ASYS_RESULT_BAD_PARAM;
+	if(!queries) return ASYS_RESULT_BAD_PARAM;
+
+	for(i = 0; i < count; ++i) {
+		struct aga_config_query* query = &queries[i];
+		enum asys_result result = ASYS_RESULT_MISSING_KEY;
+		struct aga_config_node* node = 0;
+
+		query->node = 0;
+
+		if(!query->names || !query->count) {
+			query->result = ASYS_RESULT_BAD_PARAM;
+			parent = 0;
+			continue;
+		}
+
+		if(!i || !aga_config_same_parent(query, &queries[i - 1])) {
+			parent = 0;
+
+			result = aga_config_lookup_raw(
+					root, query->names, query->count - 1, &parent);
+
+			if(result) parent = 0;
+		}
+
+		if(parent) {
+			const char** last = &query->names[query->count - 1];
+
+			result = aga_config_lookup_raw(parent, last, 1, &node);
+
+			/*
+			 * The first parent by name may not be the one holding this key
+			 * If names are repeated, in which case we fall back to a full
+			 * Lookup.
+			 */
+			if(result) {
+				result = aga_config_lookup_raw(
+						root, query->names, query->count, &node);
+			}
+		}
+
+		if(!result) {
+			query->node = node;
+
+			if(query->value) {
+				asys_bool_t found = aga_config_variable(
+						node->name, node, query->type, query->value);
+
+				if(!found) result = ASYS_RESULT_BAD_TYPE;
+			}
+		}
+
+		query->result = result;
+	}
+
+	return ASYS_RESULT_OK;
+}
+
 enum asys_result aga_config_lookup_check(
 		struct aga_config_node* root, const char** names, asys_size_t count,
 		struct aga_config_node** out) {
@@ -657,3 +1248,149 @@ enum asys_result aga_config_dump(
 	return ASYS_RESULT_NOT_IMPLEMENTED;
 #endif
 }
+
+#ifdef AGA_DEVBUILD
+static asys_size_t aga_config_count(struct aga_config_node* node) {
+	asys_size_t i, count = 1;
+
+	for(i = 0; i < node->len; ++i) {
+		count += aga_config_count(&node->children[i]);
+	}
+
+	return count;
+}
+
+static asys_uint_t aga_config_compile_string(
+		const char* string, asys_size_t* strings_size) {
+
+	asys_uint_t offset;
+
+	if(!string) return 0;
+
+	offset = (asys_uint_t) (*strings_size + 1);
+	*strings_size += asys_string_length(string) + 1;
+
+	return offset;
+}
+
+static const char* aga_config_node_string(struct aga_config_node* node) {
+	return node->type == AGA_STRING ? node->data.string : 0;
+}
+#endif
+
+enum asys_result aga_config_compile(
+		struct aga_config_node* root, struct asys_stream* stream) {
+
+#ifdef AGA_DEVBUILD
+	enum asys_result result;
+
+	struct aga_config_binary_header header = { 0 };
+	struct aga_config_node** order;
+
+	asys_size_t i, j, next = 1;
+	asys_size_t count, index_size = 0, strings_size = 0;
+
+	if(!root) return ASYS_RESULT_BAD_PARAM;
+	if(!stream) return ASYS_RESULT_BAD_PARAM;
+
+	count = aga_config_count(root);
+
+	order = asys_memory_allocate(count * sizeof(struct aga_config_node*));
+	if(!order) return ASYS_RESULT_OOM;
+
+	/* Breadth-first so that each node's children end up contiguous. */
+	order[0] = root;
+	for(i = 0; i < count; ++i) {
+		for(j = 0; j < order[i]->len; ++j) {
+			order[next++] = &order[i]->children[j];
+		}
+	}
+
+	for(i = 0; i < count; ++i) {
+		struct aga_config_node* node = order[i];
+
+		if(node->index) index_size += aga_config_index_size(node->len);
+
+		(void) aga_config_compile_string(node->name, &strings_size);
+		(void) aga_config_compile_string(
+				aga_config_node_string(node), &strings_size);
+	}
+
+	asys_memory_copy(header.magic, AGA_CONFIG_BINARY_MAGIC, 4);
+	header.count = (asys_uint_t) count;
+	header.index_size = (asys_uint_t) index_size;
+	header.strings_size = (asys_uint_t) strings_size;
+
+	result = asys_stream_write(stream, &header, sizeof(header));
+	if(result) goto cleanup;
+
+	index_size = 0;
+	strings_size = 0;
+	next = 1;
+
+	for(i = 0; i < count; ++i) {
+		struct aga_config_node* node = order[i];
+		struct aga_config_binary_node record = { 0 };
+		const char* string = aga_config_node_string(node);
+
+		record.name = aga_config_compile_string(node->name, &strings_size);
+		record.string = aga_config_compile_string(string, &strings_size);
+
+		record.type = node->type;
+		record.children = (asys_uint_t) next;
+		record.len = (asys_uint_t) node->len;
+
+		if(node->index) {
+			record.index = (asys_uint_t) (index_size + 1);
+			index_size += aga_config_index_size(node->len);
+		}
+
+		if(node->type == AGA_INTEGER) record.value = node->data.integer;
+		else if(node->type == AGA_FLOAT) record.value = node->data.flt;
+
+		next += node->len;
+
+		result = asys_stream_write(stream, &record, sizeof(record));
+		if(result) goto cleanup;
+	}
+
+	for(i = 0; i < count; ++i) {
+		struct aga_config_node* node = order[i];
+		asys_size_t size;
+
+		if(!node->index) continue;
+
+		size = aga_config_index_size(node->len) * sizeof(asys_uint_t);
+
+		result = asys_stream_write(stream, node->index, size);
+		if(result) goto cleanup;
+	}
+
+	for(i = 0; i < count; ++i) {
+		const char* strings[2];
+
+		strings[0] = order[i]->name;
+		strings[1] = aga_config_node_string(order[i]);
+
+		for(j = 0; j < ASYS_LENGTH(strings); ++j) {
+			if(!strings[j]) continue;
+
+			result = asys_stream_write(
+					stream, strings[j], asys_string_length(strings[j]) + 1);
+
+			if(result) goto cleanup;
+		}
+	}
+
+	cleanup: {
+		asys_memory_free(order);
+
+		return result;
+	}
+#else
+	(void) root;
+	(void) stream;
+
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
@@ -0,0 +1,228 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#include <aga/lz.h>
+
+#include <asys/memory.h>
+
+#define AGA_LZ_MASK (AGA_LZ_WINDOW - 1)
+
+/* The high byte marks how many items remain under the current flag byte. */
+#define AGA_LZ_FLAGS_LOADED (0x100U)
+
+void aga_lz_begin(struct aga_lz* lz) {
+	lz->head = 0;
+	lz->flags = 0;
+	lz->match = 0;
+	lz->remaining = 0;
+}
+
+asys_size_t aga_lz_decode(
+		struct aga_lz* lz, const asys_uchar_t** in, asys_size_t* in_count,
+		void* out, asys_size_t out_count) {
+
+	asys_uchar_t* bytes = out;
+	asys_size_t produced = 0;
+
+	while(produced < out_count) {
+		asys_uchar_t c;
+
+		if(lz->remaining) {
+			asys_size_t count = out_count - produced;
+
+			if(count > lz->remaining) count = lz->remaining;
+			lz->remaining -= count;
+
+			while(count--) {
+				c = lz->window[lz->match];
+				lz->match = (lz->match + 1) & AGA_LZ_MASK;
+
+				lz->window[lz->head] = c;
+				lz->head = (lz->head + 1) & AGA_LZ_MASK;
+
+				bytes[produced++] = c;
+			}
+
+			continue;
+		}
+
+		if(!(lz->flags & AGA_LZ_FLAGS_LOADED)) {
+			if(!*in_count) break;
+
+			lz->flags = *(*in)++ | 0xFF00U;
+			--*in_count;
+		}
+
+		if(lz->flags & 1) {
+			if(!*in_count) break;
+
+			c = *(*in)++;
+			--*in_count;
+
+			lz->window[lz->head] = c;
+			lz->head = (lz->head + 1) & AGA_LZ_MASK;
+
+			bytes[produced++] = c;
+		}
+		else {
+			asys_size_t distance;
+
+			if(*in_count < 2) break;
+
+			distance = (*in)[0] | (((*in)[1] & 0xF0U) << 4);
+			lz->remaining = ((*in)[1] & 0xFU) + AGA_LZ_MIN_MATCH;
+			lz->match = (lz->head - (distance + 1)) & AGA_LZ_MASK;
+
+			*in += 2;
+			*in_count -= 2;
+		}
+
+		lz->flags >>= 1;
+	}
+
+	return produced;
+}
+
+#ifdef AGA_DEVBUILD
+# define AGA_LZ_HASH_SIZE (4096)
+/* TODO: Make the compression level configurable per-input. */
+# define AGA_LZ_CHAIN (32)
+
+static asys_size_t aga_lz_hash(const asys_uchar_t* bytes) {
+	asys_size_t hash = (bytes[0] << 8) ^ (bytes[1] << 4) ^ bytes[2];
+
+	return (hash * 2654435761UL >> 8) & (AGA_LZ_HASH_SIZE - 1);
+}
+#endif
+
+enum asys_result aga_lz_encode(
+		const void* in, asys_size_t count, void** out,
+		asys_size_t* out_count) {
+
+#ifdef AGA_DEVBUILD
+	const asys_uchar_t* bytes = in;
+
+	/* Chains hold positions plus one -- zero terminates. */
+	asys_size_t* heads;
+	asys_size_t* chain;
+
+	asys_uchar_t* output;
+	asys_size_t written = 0;
+	asys_size_t flag_at = 0;
+	asys_uint_t items = 8;
+
+	asys_size_t position = 0;
+
+	if(!in) return ASYS_RESULT_BAD_PARAM;
+	if(!out) return ASYS_RESULT_BAD_PARAM;
+	if(!out_count) return ASYS_RESULT_BAD_PARAM;
+
+	/* Worst case is all literals with a flag byte for every eight. */
+	if(!(output = asys_memory_allocate(count + count / 8 + 1))) {
+		return ASYS_RESULT_OOM;
+	}
+
+	heads = asys_memory_allocate_zero(AGA_LZ_HASH_SIZE, sizeof(asys_size_t));
+	if(!heads) {
+		asys_memory_free(output);
+		return ASYS_RESULT_OOM;
+	}
+
+	chain = asys_memory_allocate_zero(AGA_LZ_WINDOW, sizeof(asys_size_t));
+	if(!chain) {
+		asys_memory_free(heads);
+		asys_memory_free(output);
+		return ASYS_RESULT_OOM;
+	}
+
+	while(position < count) {
+		asys_size_t best_length = 0;
+		asys_size_t best_distance = 0;
+		asys_size_t limit = count - position;
+		asys_size_t length, i;
+
+		if(limit > AGA_LZ_MAX_MATCH) limit = AGA_LZ_MAX_MATCH;
+
+		if(limit >= AGA_LZ_MIN_MATCH) {
+			asys_size_t candidate = heads[aga_lz_hash(&bytes[position])];
+			asys_uint_t depth = AGA_LZ_CHAIN;
+
+			while(candidate && depth--) {
+				asys_size_t at = candidate - 1;
+				asys_size_t next;
+
+				if(position - at > AGA_LZ_WINDOW) break;
+
+				for(length = 0; length < limit; ++length) {
+					if(bytes[at + length] != bytes[position + length]) break;
+				}
+
+				if(length > best_length) {
+					best_length = length;
+					best_distance = position - at;
+
+					if(length == limit) break;
+				}
+
+				/* Stale slots may point forwards once the window wraps. */
+				next = chain[at & AGA_LZ_MASK];
+				if(next >= candidate) break;
+
+				candidate = next;
+			}
+		}
+
+		if(items == 8) {
+			flag_at = written++;
+			output[flag_at] = 0;
+			items = 0;
+		}
+
+		if(best_length >= AGA_LZ_MIN_MATCH) {
+			asys_size_t distance = best_distance - 1;
+
+			output[written++] = (asys_uchar_t) (distance & 0xFF);
+			output[written++] = (asys_uchar_t) (
+					((distance >> 4) & 0xF0) |
+					(best_length - AGA_LZ_MIN_MATCH));
+
+			length = best_length;
+		}
+		else {
+			output[flag_at] |= (asys_uchar_t) (1U << items);
+			output[written++] = bytes[position];
+
+			length = 1;
+		}
+
+		++items;
+
+		for(i = 0; i < length; ++i, ++position) {
+			asys_size_t hash;
+
+			if(count - position < AGA_LZ_MIN_MATCH) continue;
+
+			hash = aga_lz_hash(&bytes[position]);
+			chain[position & AGA_LZ_MASK] = heads[hash];
+			heads[hash] = position + 1;
+		}
+	}
+
+	asys_memory_free(chain);
+	asys_memory_free(heads);
+
+	*out = output;
+	*out_count = written;
+
+	return ASYS_RESULT_OK;
+#else
+	(void) in;
+	(void) count;
+	(void) out;
+	(void) out_count;
+
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
+}
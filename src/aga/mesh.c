@@ -0,0 +1,497 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#include <aga/mesh.h>
+
+#include <asys/memory.h>
+#include <asys/math.h>
+
+#define AGA_MESH_NONE ((asys_uint_t) -1)
+
+/* Tuning from the original paper. */
+#define AGA_MESH_DECAY_POWER (1.5)
+#define AGA_MESH_LAST_SCORE (0.75f)
+#define AGA_MESH_VALENCE_SCALE (2.0f)
+#define AGA_MESH_VALENCE_POWER (0.5)
+
+/*
+ * The triangles using each vertex -- those of vertex `n' are found at
+ * `triangles[offsets[n]]' through `triangles[offsets[n + 1]]'.
+ */
+struct aga_mesh_adjacency {
+	asys_uint_t* offsets;
+	asys_uint_t* triangles;
+};
+
+static void aga_mesh_adjacency_delete(struct aga_mesh_adjacency* adjacency) {
+	asys_memory_free(adjacency->offsets);
+	asys_memory_free(adjacency->triangles);
+}
+
+static enum asys_result aga_mesh_adjacency_new(
+		const asys_uint_t* indices, asys_size_t count, asys_size_t vertices,
+		struct aga_mesh_adjacency* adjacency) {
+
+	asys_size_t i;
+
+	adjacency->offsets = asys_memory_allocate_zero(
+			vertices + 1, sizeof(asys_uint_t));
+
+	adjacency->triangles = asys_memory_allocate(
+			(count + 1) * sizeof(asys_uint_t));
+
+	if(!adjacency->offsets || !adjacency->triangles) {
+		aga_mesh_adjacency_delete(adjacency);
+		return ASYS_RESULT_OOM;
+	}
+
+	for(i = 0; i < count; ++i) {
+		if(indices[i] >= vertices) {
+			aga_mesh_adjacency_delete(adjacency);
+			return ASYS_RESULT_BAD_PARAM;
+		}
+
+		adjacency->offsets[indices[i] + 1]++;
+	}
+
+	for(i = 0; i < vertices; ++i) {
+		adjacency->offsets[i + 1] += adjacency->offsets[i];
+	}
+
+	/* Fill using the offsets as cursors then shift them back into place. */
+	for(i = 0; i < count; ++i) {
+		asys_uint_t* offset = &adjacency->offsets[indices[i]];
+
+		adjacency->triangles[(*offset)++] = (asys_uint_t) (i / 3);
+	}
+
+	for(i = vertices; i > 0; --i) {
+		adjacency->offsets[i] = adjacency->offsets[i - 1];
+	}
+
+	adjacency->offsets[0] = 0;
+
+	return ASYS_RESULT_OK;
+}
+
+static float aga_mesh_score(asys_uint_t position, asys_uint_t remaining) {
+	float score = 0.0f;
+
+	/* Vertices with nothing left to draw should never draw a triangle in. */
+	if(!remaining) return -1.0f;
+
+	if(position != AGA_MESH_NONE) {
+		/*
+		 * The most recent triangle's vertices are scored flat -- it makes no
+		 * Difference which of them the next triangle reuses.
+		 */
+		if(position < 3) score = AGA_MESH_LAST_SCORE;
+		else {
+			double scale = 1.0 / (AGA_MESH_CACHE - 3);
+			double x = 1.0 - (position - 3) * scale;
+
+			score = (float) pow(x, AGA_MESH_DECAY_POWER);
+		}
+	}
+
+	/* Boost lonely vertices so that stragglers get cleaned up early. */
+	score += AGA_MESH_VALENCE_SCALE * (float) pow(
+			remaining, -AGA_MESH_VALENCE_POWER);
+
+	return score;
+}
+
+enum asys_result aga_mesh_order(
+		asys_uint_t* indices, asys_size_t count, asys_size_t vertices) {
+
+	enum asys_result result;
+
+	struct aga_mesh_adjacency adjacency;
+
+	asys_size_t triangles = count / 3;
+
+	/* Per-vertex state -- `remaining' active triangles lead each list. */
+	asys_uint_t* remaining;
+	asys_uint_t* position;
+	float* vertex_score;
+
+	asys_bool_t* added;
+
+	asys_uint_t* out;
+
+	asys_uint_t cache[AGA_MESH_CACHE + 3];
+	asys_uint_t cache_count = 0;
+
+	asys_size_t emitted, cursor = 0;
+	asys_uint_t best = AGA_MESH_NONE;
+	float best_score = -1.0f;
+	asys_size_t i, j;
+
+	if(!indices) return ASYS_RESULT_BAD_PARAM;
+	if(count % 3) return ASYS_RESULT_BAD_PARAM;
+	if(count < 6) return ASYS_RESULT_OK;
+
+	result = aga_mesh_adjacency_new(indices, count, vertices, &adjacency);
+	if(result) return result;
+
+	remaining = asys_memory_allocate((vertices + 1) * sizeof(asys_uint_t));
+	position = asys_memory_allocate((vertices + 1) * sizeof(asys_uint_t));
+	vertex_score = asys_memory_allocate((vertices + 1) * sizeof(float));
+	added = asys_memory_allocate_zero(triangles, sizeof(asys_bool_t));
+	out = asys_memory_allocate(count * sizeof(asys_uint_t));
+
+	if(!remaining || !position || !vertex_score || !added || !out) {
+		result = ASYS_RESULT_OOM;
+		goto cleanup;
+	}
+
+	for(i = 0; i < vertices; ++i) {
+		remaining[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+		position[i] = AGA_MESH_NONE;
+		vertex_score[i] = aga_mesh_score(AGA_MESH_NONE, remaining[i]);
+	}
+
+	for(i = 0; i < triangles; ++i) {
+		const asys_uint_t* tri = &indices[3 * i];
+		float score;
+
+		score = vertex_score[tri[0]];
+		score += vertex_score[tri[1]];
+		score += vertex_score[tri[2]];
+
+		if(score > best_score) {
+			best_score = score;
+			best = (asys_uint_t) i;
+		}
+	}
+
+	for(emitted = 0; emitted < triangles; ++emitted) {
+		const asys_uint_t* tri;
+		asys_uint_t next[AGA_MESH_CACHE + 3];
+		asys_uint_t next_count = 0;
+
+		/*
+		 * Nothing in the cache has any triangles left -- carry on from the
+		 * Earliest triangle not yet drawn.
+		 */
+		if(best == AGA_MESH_NONE) {
+			while(added[cursor]) cursor++;
+			best = (asys_uint_t) cursor;
+		}
+
+		tri = &indices[3 * best];
+		asys_memory_copy(&out[3 * emitted], tri, sizeof(asys_uint_t[3]));
+		added[best] = ASYS_TRUE;
+
+		for(i = 0; i < 3; ++i) {
+			asys_uint_t v = tri[i];
+			asys_uint_t* list = &adjacency.triangles[adjacency.offsets[v]];
+
+			/* Degenerate triangles may have already been taken off. */
+			for(j = 0; j < remaining[v]; ++j) {
+				if(list[j] == best) {
+					list[j] = list[--remaining[v]];
+					list[remaining[v]] = best;
+					break;
+				}
+			}
+
+			for(j = 0; j < next_count; ++j) if(next[j] == v) break;
+			if(j == next_count) next[next_count++] = v;
+		}
+
+		for(i = 0; i < cache_count; ++i) {
+			asys_uint_t v = cache[i];
+
+			if(v == tri[0] || v == tri[1] || v == tri[2]) continue;
+
+			next[next_count++] = v;
+		}
+
+		/* Vertices pushed out of the cache still need their scores redone. */
+		for(i = 0; i < next_count; ++i) {
+			asys_uint_t v = next[i];
+
+			position[v] = i < AGA_MESH_CACHE ? (asys_uint_t) i : AGA_MESH_NONE;
+			vertex_score[v] = aga_mesh_score(position[v], remaining[v]);
+		}
+
+		best = AGA_MESH_NONE;
+		best_score = -1.0f;
+
+		for(i = 0; i < next_count; ++i) {
+			asys_uint_t v = next[i];
+			const asys_uint_t* list;
+
+			list = &adjacency.triangles[adjacency.offsets[v]];
+
+			for(j = 0; j < remaining[v]; ++j) {
+				const asys_uint_t* t = &indices[3 * list[j]];
+				float score;
+
+				score = vertex_score[t[0]];
+				score += vertex_score[t[1]];
+				score += vertex_score[t[2]];
+
+				if(score > best_score) {
+					best_score = score;
+					best = list[j];
+				}
+			}
+		}
+
+		cache_count = next_count < AGA_MESH_CACHE ? next_count : AGA_MESH_CACHE;
+		asys_memory_copy(cache, next, cache_count * sizeof(asys_uint_t));
+	}
+
+	asys_memory_copy(indices, out, count * sizeof(asys_uint_t));
+
+	result = ASYS_RESULT_OK;
+
+	cleanup: {
+		asys_memory_free(out);
+		asys_memory_free(added);
+		asys_memory_free(vertex_score);
+		asys_memory_free(position);
+		asys_memory_free(remaining);
+
+		aga_mesh_adjacency_delete(&adjacency);
+
+		return result;
+	}
+}
+
+enum asys_result aga_mesh_fetch(
+		asys_uint_t* indices, asys_size_t count, void* vertices,
+		asys_size_t vertex_count, asys_size_t size, asys_size_t* out_count) {
+
+	asys_uchar_t* bytes = vertices;
+	asys_uchar_t* reordered;
+	asys_uint_t* remap;
+
+	asys_uint_t next = 0;
+	asys_size_t i;
+
+	if(!indices) return ASYS_RESULT_BAD_PARAM;
+	if(!vertices) return ASYS_RESULT_BAD_PARAM;
+	if(!out_count) return ASYS_RESULT_BAD_PARAM;
+
+	remap = asys_memory_allocate((vertex_count + 1) * sizeof(asys_uint_t));
+	if(!remap) return ASYS_RESULT_OOM;
+
+	reordered = asys_memory_allocate((vertex_count + 1) * size);
+	if(!reordered) {
+		asys_memory_free(remap);
+		return ASYS_RESULT_OOM;
+	}
+
+	for(i = 0; i < vertex_count; ++i) remap[i] = AGA_MESH_NONE;
+
+	for(i = 0; i < count; ++i) {
+		asys_uint_t index = indices[i];
+
+		if(index >= vertex_count) {
+			asys_memory_free(reordered);
+			asys_memory_free(remap);
+
+			return ASYS_RESULT_BAD_PARAM;
+		}
+
+		if(remap[index] == AGA_MESH_NONE) {
+			asys_memory_copy(
+					&reordered[next * size], &bytes[index * size], size);
+
+			remap[index] = next++;
+		}
+
+		indices[i] = remap[index];
+	}
+
+	asys_memory_copy(vertices, reordered, next * size);
+	*out_count = next;
+
+	asys_memory_free(reordered);
+	asys_memory_free(remap);
+
+	return ASYS_RESULT_OK;
+}
+
+enum asys_result aga_mesh_acmr(
+		const asys_uint_t* indices, asys_size_t count, asys_size_t vertices,
+		asys_size_t cache, float* acmr) {
+
+	/* When each vertex last went in, as a count of misses plus one. */
+	asys_size_t* stamps;
+	asys_size_t misses = 0;
+	asys_size_t i;
+
+	if(!indices) return ASYS_RESULT_BAD_PARAM;
+	if(!acmr) return ASYS_RESULT_BAD_PARAM;
+
+	if(count < 3) {
+		*acmr = 0.0f;
+		return ASYS_RESULT_OK;
+	}
+
+	stamps = asys_memory_allocate_zero(vertices + 1, sizeof(asys_size_t));
+	if(!stamps) return ASYS_RESULT_OOM;
+
+	for(i = 0; i < count; ++i) {
+		asys_uint_t index = indices[i];
+
+		if(index >= vertices) {
+			asys_memory_free(stamps);
+			return ASYS_RESULT_BAD_PARAM;
+		}
+
+		/* A FIFO entry survives until `cache' more misses have gone in. */
+		if(stamps[index] && misses - (stamps[index] - 1) <= cache) continue;
+
+		stamps[index] = ++misses;
+	}
+
+	asys_memory_free(stamps);
+
+	*acmr = (float) misses / (float) (count / 3);
+
+	return ASYS_RESULT_OK;
+}
+
+/*
+ * Looks for an unused triangle with the directed edge `from' -> `to', giving
+ * Back its remaining vertex.
+ */
+static asys_uint_t aga_mesh_strip_find(
+		const asys_uint_t* indices, const struct aga_mesh_adjacency* adjacency,
+		const asys_bool_t* used, asys_uint_t from, asys_uint_t to,
+		asys_uint_t* triangle) {
+
+	asys_uint_t i, j;
+
+	for(i = adjacency->offsets[from]; i < adjacency->offsets[from + 1]; ++i) {
+		asys_uint_t t = adjacency->triangles[i];
+		const asys_uint_t* tri = &indices[3 * t];
+
+		if(used[t]) continue;
+
+		for(j = 0; j < 3; ++j) {
+			if(tri[j] == from && tri[(j + 1) % 3] == to) {
+				*triangle = t;
+				return tri[(j + 2) % 3];
+			}
+		}
+	}
+
+	return AGA_MESH_NONE;
+}
+
+enum asys_result aga_mesh_strip(
+		const asys_uint_t* indices, asys_size_t count, asys_size_t vertices,
+		asys_uint_t** out, asys_size_t* out_count) {
+
+	enum asys_result result;
+
+	struct aga_mesh_adjacency adjacency;
+
+	asys_size_t triangles = count / 3;
+	asys_bool_t* used;
+
+	asys_uint_t* strip;
+	asys_size_t length = 0;
+
+	asys_size_t i;
+
+	if(!indices) return ASYS_RESULT_BAD_PARAM;
+	if(!out) return ASYS_RESULT_BAD_PARAM;
+	if(!out_count) return ASYS_RESULT_BAD_PARAM;
+	if(count % 3) return ASYS_RESULT_BAD_PARAM;
+
+	result = aga_mesh_adjacency_new(indices, count, vertices, &adjacency);
+	if(result) return result;
+
+	/* At worst every triangle is a run of its own with three joins. */
+	strip = asys_memory_allocate((6 * triangles + 1) * sizeof(asys_uint_t));
+	used = asys_memory_allocate_zero(triangles + 1, sizeof(asys_bool_t));
+
+	if(!strip || !used) {
+		asys_memory_free(used);
+		asys_memory_free(strip);
+		aga_mesh_adjacency_delete(&adjacency);
+
+		return ASYS_RESULT_OOM;
+	}
+
+	for(i = 0; i < triangles; ++i) {
+		const asys_uint_t* tri = &indices[3 * i];
+		asys_uint_t first[3];
+		asys_uint_t triangle, next;
+		asys_size_t start, r;
+
+		if(used[i]) continue;
+		used[i] = ASYS_TRUE;
+
+		/* Start on whichever rotation can be carried on from. */
+		for(r = 0; r < 3; ++r) {
+			first[0] = tri[r];
+			first[1] = tri[(r + 1) % 3];
+			first[2] = tri[(r + 2) % 3];
+
+			next = aga_mesh_strip_find(
+					indices, &adjacency, used, first[2], first[1], &triangle);
+
+			if(next != AGA_MESH_NONE) break;
+		}
+
+		if(r == 3) asys_memory_copy(first, tri, sizeof(first));
+
+		/*
+		 * Runs are joined by repeating the last vertex of one and the first
+		 * Of the next -- each run must also start on an even vertex to keep
+		 * Its winding.
+		 */
+		if(length) {
+			asys_uint_t last = strip[length - 1];
+
+			if(length % 2) strip[length++] = last;
+
+			strip[length++] = last;
+			strip[length++] = first[0];
+		}
+
+		start = length;
+
+		strip[length++] = first[0];
+		strip[length++] = first[1];
+		strip[length++] = first[2];
+
+		for(;;) {
+			asys_uint_t p = strip[length - 2];
+			asys_uint_t q = strip[length - 1];
+
+			/* Odd triangles in a strip are wound the other way around. */
+			if((length - start) % 2) {
+				next = aga_mesh_strip_find(
+						indices, &adjacency, used, q, p, &triangle);
+			}
+			else {
+				next = aga_mesh_strip_find(
+						indices, &adjacency, used, p, q, &triangle);
+			}
+
+			if(next == AGA_MESH_NONE) break;
+
+			used[triangle] = ASYS_TRUE;
+			strip[length++] = next;
+		}
+	}
+
+	asys_memory_free(used);
+	aga_mesh_adjacency_delete(&adjacency);
+
+	*out = strip;
+	*out_count = length;
+
+	return ASYS_RESULT_OK;
+}
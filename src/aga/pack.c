@@ -6,9 +6,14 @@
 #include <aga/pack.h>
 
 #include <asys/log.h>
+#include <asys/error.h>
 #include <asys/memory.h>
 #include <asys/string.h>
 
+#ifdef AGA_DEVBUILD
+# include <apro.h>
+#endif
+
 /*
  * TODO: Allow inplace use of UNIX `compress'/`uncompress' utilities on pack
  * 		 In distribution.
@@ -25,49 +30,730 @@
 /* TODO: Hopefully we eventually won't need this anymore. */
 struct aga_resource_pack* aga_global_pack = 0;
 
+/*
+ * Names are normalised as they are hashed so that Win32-style separators in
+ * Lookup paths land on the same slot as the `/'-separated names emitted by
+ * `aga_build'.
+ */
+asys_size_t aga_resource_pack_hash(const char* name) {
+	asys_size_t hash = 5381;
+
+	for(; *name; ++name) {
+		char c = *name;
+
+#ifdef ASYS_WIN32
+		if(c == '\\') c = '/';
+#endif
+
+		hash = ((hash << 5) + hash) ^ (asys_uchar_t) c;
+	}
+
+	return hash;
+}
+
+static asys_bool_t aga_resource_pack_name_equal(
+		const char* name, const char* path) {
+
+#ifdef ASYS_WIN32
+	asys_size_t i;
+
+	for(i = 0; path[i] && name[i]; ++i) {
+		if(path[i] == name[i]) continue;
+		else if(path[i] == '\\' && name[i] == '/') continue;
+		else break;
+	}
+
+	return path[i] == name[i];
+#else
+	return asys_string_equal(name, path);
+#endif
+}
+
+static enum asys_result aga_resource_pack_index(
+		struct aga_resource_pack* pack) {
+
+	asys_size_t i;
+	asys_size_t mask;
+
+	/* Keep the load factor at or below one half. */
+	pack->index_size = 1;
+	while(pack->index_size < pack->count * 2) pack->index_size <<= 1;
+
+	pack->index = asys_memory_allocate_zero(
+			pack->index_size, sizeof(asys_size_t));
+
+	if(!pack->index) return ASYS_RESULT_OOM;
+
+	mask = pack->index_size - 1;
+
+	for(i = 0; i < pack->count; ++i) {
+		const char* name = pack->resources[i].name;
+		asys_size_t slot;
+
+		slot = aga_resource_pack_hash(name) & mask;
+
+		/* The first entry for a given name wins, as with a linear search. */
+		while(pack->index[slot]) {
+			struct aga_resource* other;
+
+			other = &pack->resources[pack->index[slot] - 1];
+
+			if(aga_resource_pack_name_equal(other->name, name)) break;
+
+			slot = (slot + 1) & mask;
+		}
+
+		if(!pack->index[slot]) pack->index[slot] = i + 1;
+	}
+
+	return ASYS_RESULT_OK;
+}
+
+/*
+ * Mapping is an optimisation only -- any failure here leaves the pack on the
+ * Read-and-copy path.
+ */
+static void aga_resource_pack_map(struct aga_resource_pack* pack) {
+	enum asys_result result;
+	union asys_file_attribute attribute;
+
+	result = asys_stream_attribute(
+			&pack->stream, ASYS_FILE_LENGTH, &attribute);
+
+	if(!result) {
+		result = asys_stream_map(
+				&pack->stream, attribute.length, &pack->map);
+	}
+
+	if(result) {
+		asys_log(
+				__FILE__,
+				"Resource pack could not be mapped, falling back to reads");
+
+		pack->map = 0;
+		return;
+	}
+
+	pack->map_size = attribute.length;
+}
+
 enum asys_result aga_resource_pack_lookup(
 		struct aga_resource_pack* pack, const char* path,
 		struct aga_resource** out) {
 
-	asys_size_t i;
+	asys_size_t slot;
+	asys_size_t mask;
+
+	if(!pack) return ASYS_RESULT_BAD_PARAM;
+	if(!path) return ASYS_RESULT_BAD_PARAM;
+	if(!out) return ASYS_RESULT_BAD_PARAM;
+
+	if(pack->index_size) {
+		mask = pack->index_size - 1;
+		slot = aga_resource_pack_hash(path) & mask;
+
+		while(pack->index[slot]) {
+			struct aga_resource* resource;
+
+			resource = &pack->resources[pack->index[slot] - 1];
+
+			if(aga_resource_pack_name_equal(resource->name, path)) {
+				*out = resource;
+				return ASYS_RESULT_OK;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+	}
+
+	asys_log(__FILE__, "err: Path `%s' not found in resource pack", path);
+
+	return ASYS_RESULT_MISSING_KEY;
+}
+
+static enum asys_result aga_resource_pack_load_binary(
+		struct aga_resource_pack* pack, asys_size_t size) {
+
+	enum asys_result result;
+
+	asys_size_t i;
+	const asys_uchar_t* directory;
+	const struct aga_resource_pack_entry* entries;
+	const char* strings;
+	asys_uint_t count;
+	asys_size_t table_size, strings_size;
+
+	if(pack->map) {
+		asys_size_t start = sizeof(struct aga_resource_pack_header);
+
+		if(size > pack->map_size - start) return ASYS_RESULT_BAD_PARAM;
+
+		directory = (asys_uchar_t*) pack->map + start;
+	}
+	else {
+		if(!(pack->directory = asys_memory_allocate(size))) {
+			return ASYS_RESULT_OOM;
+		}
+
+		result = asys_stream_read_at(
+				&pack->stream, sizeof(struct aga_resource_pack_header), 0,
+				pack->directory, size);
+
+		if(result) return result;
+
+		directory = pack->directory;
+	}
+
+	if(size < sizeof(count)) return ASYS_RESULT_BAD_PARAM;
+
+	asys_memory_copy(&count, directory, sizeof(count));
+
+	/* Checked before multiplying as the table size could otherwise wrap. */
+	table_size = size - sizeof(count);
+	if(count > table_size / sizeof(struct aga_resource_pack_entry)) {
+		return ASYS_RESULT_BAD_PARAM;
+	}
+
+	table_size = count * sizeof(struct aga_resource_pack_entry);
+
+	/* Both the header and entries keep everything word-aligned. */
+	entries = (const void*) (directory + sizeof(count));
+	strings = (const char*) entries + table_size;
+	strings_size = size - sizeof(count) - table_size;
+
+	if(count && (!strings_size || strings[strings_size - 1])) {
+		asys_log(__FILE__, "err: Unterminated pack directory string table");
+		return ASYS_RESULT_BAD_PARAM;
+	}
+
+	pack->count = count;
+	pack->resources = asys_memory_allocate_zero(
+			pack->count, sizeof(struct aga_resource));
+
+	if(!pack->resources) return ASYS_RESULT_OOM;
+
+	for(i = 0; i < pack->count; ++i) {
+		struct aga_resource* resource = &pack->resources[i];
+		const struct aga_resource_pack_entry* entry = &entries[i];
+
+		if(entry->name >= strings_size) return ASYS_RESULT_BAD_PARAM;
+
+		resource->pack = pack;
+		resource->name = &strings[entry->name];
+		resource->offset = entry->offset;
+		resource->size = entry->size;
+		resource->stored = entry->stored;
+		resource->flags = entry->flags;
+		resource->version = entry->version;
+		resource->width = entry->width;
+
+		asys_memory_copy(
+				resource->extent, entry->extent, sizeof(aga_model_tail_t));
+	}
+
+	return ASYS_RESULT_OK;
+}
+
+/*
+ * Old packs are parsed once to fill in the same fields as a binary directory
+ * Would -- the parsed tree is not kept around afterwards.
+ */
+static enum asys_result aga_resource_pack_load_sgml(
+		struct aga_resource_pack* pack, asys_size_t size) {
+
+	static const char* extent_names[] = {
+			"MinX", "MinY", "MinZ", "MaxX", "MaxY", "MaxZ"
+	};
+
+	static const char* offset_name = "Offset";
+	static const char* size_name = "Size";
+	static const char* width_name = "Width";
+	static const char* version_name = "Version";
+
+	enum asys_result result;
+
+	asys_size_t i, j;
+	asys_size_t count, strings_size = 0;
+	char* strings;
+
+	struct aga_config_node root;
+	struct aga_config_node* nodes;
+
+	/* The config parser reads sequentially from just past the header. */
+	result = asys_stream_seek(
+			&pack->stream, ASYS_SEEK_SET,
+			sizeof(struct aga_resource_pack_header));
+
+	if(result) return result;
+
+	result = aga_config_new(&pack->stream, size, &root);
+	if(result) return result;
+
+	count = root.children->len;
+	nodes = root.children->children;
+
+	for(i = 0; i < count; ++i) {
+		if(nodes[i].name) strings_size += asys_string_length(nodes[i].name) + 1;
+	}
+
+	pack->resources = asys_memory_allocate_zero(
+			count, sizeof(struct aga_resource));
+
+	if(!pack->resources) {
+		result = ASYS_RESULT_OOM;
+		goto cleanup;
+	}
+
+	if(!(pack->directory = asys_memory_allocate(strings_size + 1))) {
+		result = ASYS_RESULT_OOM;
+		goto cleanup;
+	}
+
+	strings = pack->directory;
+
+	for(i = 0; i < count; ++i) {
+		struct aga_resource* resource = &pack->resources[pack->count];
+		struct aga_config_node* node = &nodes[i];
+
+		aga_config_int_t v;
+		double f;
+		asys_size_t offset, length, name_length;
+
+		if(!node->name) continue;
+
+		result = aga_config_lookup(
+				node, &offset_name, 1, &v, AGA_INTEGER, ASYS_TRUE);
+
+		if(result) continue;
+		offset = v;
+
+		result = aga_config_lookup(
+				node, &size_name, 1, &v, AGA_INTEGER, ASYS_TRUE);
+
+		if(result) continue;
+		length = v;
+
+		result = aga_config_lookup(
+				node, &width_name, 1, &v, AGA_INTEGER, ASYS_FALSE);
+
+		resource->width = result ? 0 : (aga_image_tail_t) v;
+
+		result = aga_config_lookup(
+				node, &version_name, 1, &v, AGA_INTEGER, ASYS_FALSE);
+
+		resource->version = result ? 0 : (asys_uint_t) v;
+
+		for(j = 0; j < ASYS_LENGTH(extent_names); ++j) {
+			result = aga_config_lookup(
+					node, &extent_names[j], 1, &f, AGA_FLOAT, ASYS_FALSE);
+
+			resource->extent[j] = result ? 0.0f : (float) f;
+		}
+
+		name_length = asys_string_length(node->name) + 1;
+		asys_memory_copy(strings, node->name, name_length);
+
+		/* Only make a valid resource entry once all checks have passed. */
+		resource->pack = pack;
+		resource->name = strings;
+		resource->offset = (asys_size_t) offset;
+		resource->size = (asys_size_t) length;
+		resource->stored = resource->size;
+
+		strings += name_length;
+		pack->count++;
+	}
+
+	return aga_config_delete(&root);
+
+	cleanup: {
+		asys_log_result(
+				__FILE__, "aga_config_delete", aga_config_delete(&root));
+
+		return result;
+	}
+}
+
+/*
+ * NOTE: Only uses from the main thread are traced -- prefetches are just a
+ * 		 Hint that a resource may be used later.
+ */
+static void aga_resource_trace(struct aga_resource* resource) {
+#ifdef AGA_DEVBUILD
+	static const char item[] =
+			"\t\t<item name=\"%s\">\n"
+			"\t\t\t<item name=\"Time\" type=\"Integer\">\n"
+			"\t\t\t\t" ASYS_NATIVE_ULONG_FORMAT "\n"
+			"\t\t\t</item>\n"
+			"\t\t\t<item name=\"Size\" type=\"Integer\">\n"
+			"\t\t\t\t" ASYS_NATIVE_ULONG_FORMAT "\n"
+			"\t\t\t</item>\n"
+			"\t\t</item>\n";
+
+	enum asys_result result;
+
+	struct aga_resource_pack* pack = resource->pack;
+	asys_size_t time;
+
+	if(!pack->tracing || resource->traced) return;
+
+	resource->traced = ASYS_TRUE;
+	time = apro_time_us() - pack->trace_start;
+
+	result = asys_stream_write_format(
+			&pack->trace, item, resource->name, time, resource->size);
+
+	if(result) {
+		asys_log_result(__FILE__, "asys_stream_write_format", result);
+		asys_log(__FILE__, "err: Resource trace is incomplete");
+
+		pack->tracing = ASYS_FALSE;
+
+		asys_log_result(
+				__FILE__, "asys_stream_delete",
+				asys_stream_delete(&pack->trace));
+	}
+#else
+	(void) resource;
+#endif
+}
+
+static void aga_resource_pack_lock(struct aga_resource_pack* pack) {
+	enum asys_result result;
+
+	if(!pack->threaded) return;
+
+	result = asys_mutex_lock(&pack->lock);
+	asys_result_check(__FILE__, "asys_mutex_lock", result);
+}
+
+static void aga_resource_pack_unlock(struct aga_resource_pack* pack) {
+	enum asys_result result;
+
+	if(!pack->threaded) return;
+
+	result = asys_mutex_unlock(&pack->lock);
+	asys_result_check(__FILE__, "asys_mutex_unlock", result);
+}
+
+static void aga_resource_pack_wait(
+		struct aga_resource_pack* pack, struct asys_condition* condition) {
+
+	enum asys_result result;
+
+	result = asys_condition_wait(condition, &pack->lock);
+	asys_result_check(__FILE__, "asys_condition_wait", result);
+}
+
+static void aga_resource_pack_signal(struct asys_condition* condition) {
+	enum asys_result result;
+
+	result = asys_condition_signal(condition);
+	asys_result_check(__FILE__, "asys_condition_signal", result);
+}
+
+/*
+ * Mapped data is only handed out in-place where it is suitably aligned --
+ * Packs built before data was aligned are copied out as though unmapped. The
+ * Map itself is page aligned so only the offset into it matters.
+ */
+static asys_bool_t aga_resource_in_place(const struct aga_resource* resource) {
+	const struct aga_resource_pack* pack = resource->pack;
+	asys_size_t offset = pack->data_offset + resource->offset;
+
+	if(!pack->map || (resource->flags & AGA_RESOURCE_COMPRESSED)) {
+		return ASYS_FALSE;
+	}
+
+	return !(offset % AGA_PACK_ALIGN);
+}
+
+/* Mapped data is owned by the pack and does not count against the budget. */
+static asys_size_t aga_resource_charge(struct aga_resource* resource) {
+	if(aga_resource_in_place(resource)) return 0;
+
+	return resource->size;
+}
+
+static void aga_resource_lru_push(struct aga_resource* resource) {
+	struct aga_resource_pack* pack = resource->pack;
+
+	resource->lru_prev = pack->lru_tail;
+	resource->lru_next = 0;
+
+	if(pack->lru_tail) pack->lru_tail->lru_next = resource;
+	else pack->lru_head = resource;
+
+	pack->lru_tail = resource;
+}
+
+static void aga_resource_lru_remove(struct aga_resource* resource) {
+	struct aga_resource_pack* pack = resource->pack;
+
+	if(resource->lru_prev) resource->lru_prev->lru_next = resource->lru_next;
+	else pack->lru_head = resource->lru_next;
+
+	if(resource->lru_next) resource->lru_next->lru_prev = resource->lru_prev;
+	else pack->lru_tail = resource->lru_prev;
+
+	resource->lru_prev = 0;
+	resource->lru_next = 0;
+}
+
+static void aga_resource_evict(struct aga_resource* resource) {
+	struct aga_resource_pack* pack = resource->pack;
+	asys_size_t charge = aga_resource_charge(resource);
+
+	aga_resource_lru_remove(resource);
+
+#ifndef NDEBUG
+	pack->outstanding_refs--;
+#endif
+
+	if(charge) asys_memory_free(resource->data);
+	pack->resident -= charge;
+
+	resource->data = 0;
+}
+
+static enum asys_result aga_resource_check_bounds(
+		struct aga_resource* resource) {
+
+	struct aga_resource_pack* pack = resource->pack;
+	asys_size_t offset = pack->data_offset + resource->offset;
+
+	if(!pack->map) return ASYS_RESULT_OK;
+
+	if(offset > pack->map_size || resource->stored > pack->map_size - offset) {
+		asys_log(
+				__FILE__, "err: Resource `%s' lies outside of pack data",
+				resource->name);
+
+		return ASYS_RESULT_BAD_PARAM;
+	}
+
+	return ASYS_RESULT_OK;
+}
+
+static enum asys_result aga_resource_reader_begin(
+		struct aga_resource* resource, struct aga_resource_reader* reader) {
+
+	reader->resource = resource;
+	reader->stream = &resource->pack->stream;
+	reader->position = 0;
+	reader->fetched = 0;
+	reader->buffer_start = 0;
+	reader->buffer_end = 0;
+
+	aga_lz_begin(&reader->lz);
+
+	return aga_resource_check_bounds(resource);
+}
+
+/*
+ * Produces a resource's data without touching any shared pack state, so is
+ * Safe to call from the prefetch worker through its own stream.
+ */
+static enum asys_result aga_resource_fetch(
+		struct aga_resource* resource, struct asys_stream* stream,
+		void** data) {
+
+	enum asys_result result;
+
+	struct aga_resource_pack* pack = resource->pack;
+	asys_size_t offset = pack->data_offset + resource->offset;
+
+	if((result = aga_resource_check_bounds(resource))) return result;
+
+	if(resource->flags & AGA_RESOURCE_COMPRESSED) {
+		struct aga_resource_reader reader;
+
+		if(!(*data = asys_memory_allocate(resource->size))) {
+			return ASYS_RESULT_OOM;
+		}
+
+		result = aga_resource_reader_begin(resource, &reader);
+		if(!result) {
+			reader.stream = stream;
+			result = aga_resource_read(&reader, *data, resource->size, 0);
+		}
+	}
+	else if(aga_resource_in_place(resource)) {
+		*data = (asys_uchar_t*) pack->map + offset;
+
+		return ASYS_RESULT_OK;
+	}
+	else {
+		if(!(*data = asys_memory_allocate(resource->size))) {
+			return ASYS_RESULT_OOM;
+		}
+
+		result = asys_stream_read_at(
+				stream, (asys_offset_t) offset, 0, *data, resource->size);
+	}
+
+	if(result) {
+		asys_memory_free(*data);
+		*data = 0;
+	}
+
+	return result;
+}
+
+/* NOTE: Expects the pack lock to be held. */
+static void aga_resource_install(struct aga_resource* resource, void* data) {
+	struct aga_resource_pack* pack = resource->pack;
+
+	resource->data = data;
+
+#ifndef NDEBUG
+	pack->outstanding_refs++;
+#endif
+
+	pack->resident += aga_resource_charge(resource);
+}
+
+/* Faults mapped pages in ahead of time so that first use does not stall. */
+static void aga_resource_touch(const void* data, asys_size_t size) {
+	const volatile asys_uchar_t* bytes = data;
+	asys_size_t i;
+
+	for(i = 0; i < size; i += AGA_RESOURCE_PAGE) (void) bytes[i];
+}
+
+/*
+ * NOTE: The worker only logs on failure -- its output may interleave with
+ * 		 That of the main thread.
+ */
+static void aga_resource_prefetcher(void* argument) {
+	struct aga_resource_pack* pack = argument;
+
+	aga_resource_pack_lock(pack);
+
+	while(ASYS_TRUE) {
+		enum asys_result result;
+		struct aga_resource* resource;
+		void* data;
+
+		while(!pack->prefetch_head && !pack->quit) {
+			aga_resource_pack_wait(pack, &pack->queued);
+		}
+
+		if(pack->quit) break;
+
+		resource = pack->prefetch_head;
+		pack->prefetch_head = resource->prefetch_next;
+		if(!pack->prefetch_head) pack->prefetch_tail = 0;
+
+		resource->prefetch_next = 0;
+
+		/* It may have been loaded on demand while it sat in the queue. */
+		if(!resource->data) {
+			resource->prefetch = AGA_PREFETCH_LOADING;
+			aga_resource_pack_unlock(pack);
+
+			result = aga_resource_fetch(
+					resource, &pack->prefetch_stream, &data);
+
+			if(!result && aga_resource_in_place(resource)) {
+				aga_resource_touch(data, resource->size);
+			}
+
+			aga_resource_pack_lock(pack);
+
+			if(result) {
+				asys_log(
+						__FILE__, "err: Failed to prefetch resource `%s'",
+						resource->name);
+			}
+			else {
+				aga_resource_install(resource, data);
+				if(!resource->refcount) aga_resource_lru_push(resource);
+			}
+		}
+
+		resource->prefetch = AGA_PREFETCH_NONE;
+		pack->pending--;
+
+		aga_resource_pack_signal(&pack->loaded);
+	}
+
+	aga_resource_pack_unlock(pack);
+}
+
+/*
+ * Failing to start the worker is not fatal -- prefetches then just load
+ * Inline.
+ */
+static void aga_resource_pack_prefetcher_new(
+		struct aga_resource_pack* pack, const char* path) {
+
+	struct asys_thread* thread = &pack->prefetcher;
+
+	if(asys_stream_new(&pack->prefetch_stream, path)) goto unavailable;
+	if(asys_mutex_new(&pack->lock)) goto stream;
+	if(asys_condition_new(&pack->queued)) goto lock;
+	if(asys_condition_new(&pack->loaded)) goto queued;
+
+	/* Set ahead of time so that the worker takes the lock from the start. */
+	pack->threaded = ASYS_TRUE;
+
+	if(!asys_thread_new(thread, aga_resource_prefetcher, pack)) return;
+
+	pack->threaded = ASYS_FALSE;
+
+	asys_log_result(
+			__FILE__, "asys_condition_delete",
+			asys_condition_delete(&pack->loaded));
+
+	queued: {
+		asys_log_result(
+				__FILE__, "asys_condition_delete",
+				asys_condition_delete(&pack->queued));
+	}
+
+	lock: {
+		asys_log_result(
+				__FILE__, "asys_mutex_delete", asys_mutex_delete(&pack->lock));
+	}
+
+	stream: {
+		asys_log_result(
+				__FILE__, "asys_stream_delete",
+				asys_stream_delete(&pack->prefetch_stream));
+	}
+
+	unavailable: {
+		asys_log(
+				__FILE__,
+				"warn: Resource prefetching is unavailable -- prefetches will"
+				" load inline");
+	}
+}
 
-	if(!pack) return ASYS_RESULT_BAD_PARAM;
-	if(!path) return ASYS_RESULT_BAD_PARAM;
-	if(!out) return ASYS_RESULT_BAD_PARAM;
+static enum asys_result aga_resource_pack_prefetcher_delete(
+		struct aga_resource_pack* pack) {
 
-	for(i = 0; i < pack->count; ++i) {
-		struct aga_resource* resource = &pack->resources[i];
-		const char* name;
+	enum asys_result result;
 
-		if(!resource->config) continue;
+	if(!pack->threaded) return ASYS_RESULT_OK;
 
-		name = resource->config->name;
+	aga_resource_pack_lock(pack);
 
-		if(asys_string_equal(name, path)) {
-			*out = &pack->resources[i];
-			return ASYS_RESULT_OK;
-		}
-#ifdef ASYS_WIN32
-		else {
-			asys_size_t j;
+	pack->quit = ASYS_TRUE;
+	aga_resource_pack_signal(&pack->queued);
 
-			for(j = 0; path[j] && name[j]; ++j) {
-				if(path[j] == name[j]) continue;
-				else if(path[j] == '\\' && name[j] == '/') continue;
-				else break;
-			}
+	aga_resource_pack_unlock(pack);
 
-			if(path[j] == name[j]) {
-				*out = &pack->resources[i];
-				return ASYS_RESULT_OK;
-			}
-		}
-#endif
-	}
+	if((result = asys_thread_join(&pack->prefetcher))) return result;
 
-	asys_log(__FILE__, "err: Path `%s' not found in resource pack", path);
+	pack->threaded = ASYS_FALSE;
 
-	return ASYS_RESULT_MISSING_KEY;
+	if((result = asys_condition_delete(&pack->loaded))) return result;
+	if((result = asys_condition_delete(&pack->queued))) return result;
+	if((result = asys_mutex_delete(&pack->lock))) return result;
+
+	return asys_stream_delete(&pack->prefetch_stream);
 }
 
 enum asys_result aga_resource_pack_new(
@@ -75,7 +761,6 @@ enum asys_result aga_resource_pack_new(
 
 	enum asys_result result;
 
-	asys_size_t i;
 	struct aga_resource_pack_header header;
 
 	if(!path) return ASYS_RESULT_BAD_PARAM;
@@ -84,7 +769,6 @@ enum asys_result aga_resource_pack_new(
 	aga_global_pack = pack;
 
 	asys_memory_zero(pack, sizeof(struct aga_resource_pack));
-	asys_memory_zero(&pack->root, sizeof(struct aga_config_node));
 
 #ifndef NDEBUG
 	pack->outstanding_refs = 0;
@@ -94,68 +778,49 @@ enum asys_result aga_resource_pack_new(
 
 	if((result = asys_stream_new(&pack->stream, path))) return result;
 
-	result = asys_stream_read(
-			&pack->stream, 0, &header,
+	result = asys_stream_read_at(
+			&pack->stream, 0, 0, &header,
 			sizeof(struct aga_resource_pack_header));
 
 	if(result) goto cleanup;
 
-	if(header.magic != AGA_PACK_MAGIC) {
+	aga_resource_pack_map(pack);
+
+	if(header.magic == AGA_PACK_BINARY_MAGIC) {
+		result = aga_resource_pack_load_binary(pack, header.size);
+		if(result) goto cleanup;
+	}
+	else if(header.magic == AGA_PACK_MAGIC) {
+		asys_log(
+				__FILE__,
+				"warn: Resource pack uses a legacy SGML directory -- rebuild"
+				" it to avoid parsing on startup");
+
+		result = aga_resource_pack_load_sgml(pack, header.size);
+		if(result) goto cleanup;
+	}
+	else {
 		asys_log(
 				__FILE__,
 				"Invalid resource pack magic. Expected `%x', got `%x'",
-				AGA_PACK_MAGIC, header.magic);
+				AGA_PACK_BINARY_MAGIC, header.magic);
 
 		result = ASYS_RESULT_BAD_PARAM;
 		goto cleanup;
 	}
 
-	/*
-	 * TODO: Needing to keep the entire resource pack header config loaded
-	 * 		 Is not a terribly efficient use of our memory. Can we avoid this?
-	 */
-	result = aga_config_new(&pack->stream, header.size, &pack->root);
-	if(result) goto cleanup;
-
-	pack->count = pack->root.children->len;
 	pack->data_offset = header.size + sizeof(header);
 
-	pack->resources = asys_memory_allocate_zero(
-			pack->count, sizeof(struct aga_resource));
-
-	if(!pack->resources) {
-		result = ASYS_RESULT_OOM;
-		goto cleanup;
+	if(pack->map && pack->data_offset % AGA_PACK_ALIGN) {
+		asys_log(
+				__FILE__,
+				"warn: Resource pack data is unaligned -- rebuild it to use"
+				" mapped data in-place");
 	}
 
-	for(i = 0; i < pack->count; ++i) {
-		static const char* offset_name = "Offset";
-		static const char* size_name = "Size";
-
-		struct aga_resource* resource = &pack->resources[i];
-		struct aga_config_node* node = &pack->root.children->children[i];
-
-		aga_config_int_t v;
-		asys_size_t offset, size;
-
-		result = aga_config_lookup(
-				node, &offset_name, 1, &v, AGA_INTEGER, ASYS_TRUE);
-
-		if(result) continue;
-		offset = v;
-
-		result = aga_config_lookup(
-				node, &size_name, 1, &v, AGA_INTEGER, ASYS_TRUE);
-
-		if(result) continue;
-		size = v;
+	if((result = aga_resource_pack_index(pack))) goto cleanup;
 
-		/* Only make a valid resource entry once all checks have passed. */
-		resource->config = node;
-		resource->pack = pack;
-		resource->offset = (asys_size_t) offset;
-		resource->size = (asys_size_t) size;
-	}
+	aga_resource_pack_prefetcher_new(pack, path);
 
 	asys_log(
 			__FILE__,
@@ -165,16 +830,20 @@ enum asys_result aga_resource_pack_new(
 	return ASYS_RESULT_OK;
 
 	cleanup: {
+		asys_memory_free(pack->index);
 		asys_memory_free(pack->resources);
+		asys_memory_free(pack->directory);
+
+		if(pack->map) {
+			asys_log_result(
+					__FILE__, "asys_stream_unmap",
+					asys_stream_unmap(pack->map, pack->map_size));
+		}
 
 		asys_log_result(
 				__FILE__, "asys_stream_delete",
 				asys_stream_delete(&pack->stream));
 
-		asys_log_result(
-				__FILE__, "aga_config_delete",
-				aga_config_delete(&pack->root));
-
 		return result;
 	}
 }
@@ -184,7 +853,23 @@ enum asys_result aga_resource_pack_delete(struct aga_resource_pack* pack) {
 
 	if(!pack) return ASYS_RESULT_BAD_PARAM;
 
-	if((result = aga_resource_pack_sweep(pack))) return result;
+	if((result = aga_resource_pack_prefetcher_delete(pack))) return result;
+
+#ifdef AGA_DEVBUILD
+	if(pack->tracing) {
+		static const char footer[] = "\t</item>\n</root>\n";
+
+		pack->tracing = ASYS_FALSE;
+
+		result = asys_stream_write(&pack->trace, footer, sizeof(footer) - 1);
+		asys_log_result(__FILE__, "asys_stream_write", result);
+
+		result = asys_stream_delete(&pack->trace);
+		asys_log_result(__FILE__, "asys_stream_delete", result);
+	}
+#endif
+
+	while(pack->lru_head) aga_resource_evict(pack->lru_head);
 
 #ifndef NDEBUG
 	if(pack->outstanding_refs) {
@@ -195,38 +880,151 @@ enum asys_result aga_resource_pack_delete(struct aga_resource_pack* pack) {
 	}
 #endif
 
+	if(pack->map) {
+		if((result = asys_stream_unmap(pack->map, pack->map_size))) {
+			return result;
+		}
+	}
+
+	asys_memory_free(pack->index);
 	asys_memory_free(pack->resources);
+	asys_memory_free(pack->directory);
+
+	return asys_stream_delete(&pack->stream);
+}
+
+enum asys_result aga_resource_pack_trace(
+		struct aga_resource_pack* pack, const char* path) {
 
-	result = asys_stream_delete(&pack->stream);
+#ifdef AGA_DEVBUILD
+	static const char header[] = "<root>\n\t<item name=\"Trace\">\n";
+
+	enum asys_result result;
+
+	if(!pack) return ASYS_RESULT_BAD_PARAM;
+	if(!path) return ASYS_RESULT_BAD_PARAM;
+
+	if(pack->tracing) return ASYS_RESULT_BAD_OP;
+
+	if((result = asys_stream_new_write(&pack->trace, path))) return result;
+
+	result = asys_stream_write(&pack->trace, header, sizeof(header) - 1);
 	if(result) {
 		asys_log_result(
-				__FILE__, "aga_config_delete", aga_config_delete(&pack->root));
+				__FILE__, "asys_stream_delete",
+				asys_stream_delete(&pack->trace));
 
 		return result;
 	}
 
-	return aga_config_delete(&pack->root);
+	pack->tracing = ASYS_TRUE;
+	pack->trace_start = apro_time_us();
+
+	asys_log(__FILE__, "Tracing resource use to `%s'", path);
+
+	return ASYS_RESULT_OK;
+#else
+	(void) pack;
+	(void) path;
+
+	return ASYS_RESULT_NOT_IMPLEMENTED;
+#endif
 }
 
 enum asys_result aga_resource_pack_sweep(struct aga_resource_pack* pack) {
-	asys_size_t i;
+	if(!pack) return ASYS_RESULT_BAD_PARAM;
+
+	aga_resource_pack_lock(pack);
+
+	while(pack->lru_head && pack->resident > pack->budget) {
+		aga_resource_evict(pack->lru_head);
+	}
+
+	aga_resource_pack_unlock(pack);
+
+	return ASYS_RESULT_OK;
+}
+
+enum asys_result aga_resource_pack_pending(
+		struct aga_resource_pack* pack, asys_size_t* pending) {
 
 	if(!pack) return ASYS_RESULT_BAD_PARAM;
+	if(!pending) return ASYS_RESULT_BAD_PARAM;
 
-	for(i = 0; i < pack->count; ++i) {
-		struct aga_resource* resource = &pack->resources[i];
+	aga_resource_pack_lock(pack);
+	*pending = pack->pending;
+	aga_resource_pack_unlock(pack);
 
-		if(resource->refcount || !resource->data) continue;
+	return ASYS_RESULT_OK;
+}
 
-#ifndef NDEBUG
-		pack->outstanding_refs--;
-#endif
+/* NOTE: Expects the pack lock to be held. */
+static void aga_resource_dequeue(struct aga_resource* resource) {
+	struct aga_resource_pack* pack = resource->pack;
+	struct aga_resource* previous = 0;
+	struct aga_resource* it;
 
-		asys_memory_free(resource->data);
-		resource->data = 0;
+	for(it = pack->prefetch_head; it; it = it->prefetch_next) {
+		if(it == resource) break;
+		previous = it;
 	}
 
-	return ASYS_RESULT_OK;
+	if(!it) return;
+
+	if(previous) previous->prefetch_next = resource->prefetch_next;
+	else pack->prefetch_head = resource->prefetch_next;
+
+	if(pack->prefetch_tail == resource) pack->prefetch_tail = previous;
+
+	resource->prefetch_next = 0;
+	resource->prefetch = AGA_PREFETCH_NONE;
+	pack->pending--;
+}
+
+/*
+ * NOTE: Expects the pack lock to be held -- it is dropped while the data is
+ * 		 Fetched.
+ */
+static enum asys_result aga_resource_load(struct aga_resource* resource) {
+	enum asys_result result;
+
+	struct aga_resource_pack* pack = resource->pack;
+	void* data;
+
+	/* Rather than racing the worker for an in-flight load just wait it out. */
+	while(resource->prefetch == AGA_PREFETCH_LOADING) {
+		aga_resource_pack_wait(pack, &pack->loaded);
+	}
+
+	/* The worker parks what it loads on the LRU until it is first used. */
+	if(resource->data) {
+		if(!resource->refcount) aga_resource_lru_remove(resource);
+
+		return ASYS_RESULT_OK;
+	}
+
+	/* A queued prefetch is taken over so that the worker never sees it. */
+	if(resource->prefetch == AGA_PREFETCH_QUEUED) {
+		aga_resource_dequeue(resource);
+	}
+
+	/*
+	 * As with the worker the fetch happens outside of the lock so as not to
+	 * Hold up prefetches -- marking it as loading keeps others off of it.
+	 */
+	resource->prefetch = AGA_PREFETCH_LOADING;
+	aga_resource_pack_unlock(pack);
+
+	result = aga_resource_fetch(resource, &pack->stream, &data);
+
+	aga_resource_pack_lock(pack);
+	resource->prefetch = AGA_PREFETCH_NONE;
+
+	if(!result) aga_resource_install(resource, data);
+
+	aga_resource_pack_signal(&pack->loaded);
+
+	return result;
 }
 
 enum asys_result aga_resource_new(
@@ -245,27 +1043,59 @@ enum asys_result aga_resource_new(
 		return result;
 	}
 
-	if(!(*resource)->data) {
-		result = aga_resource_seek(*resource, 0);
-		if(result) return result;
+	aga_resource_pack_lock(pack);
 
-#ifndef NDEBUG
-		pack->outstanding_refs++;
-#endif
+	if(!(*resource)->data) result = aga_resource_load(*resource);
+	else if(!(*resource)->refcount) aga_resource_lru_remove(*resource);
 
-		/* TODO: Use mapping for large reads. */
-		(*resource)->data = asys_memory_allocate((*resource)->size);
-		if(!(*resource)->data) return ASYS_RESULT_OOM;
+	if(!result) ++(*resource)->refcount;
 
-		result = asys_stream_read(
-				&pack->stream, 0, (*resource)->data, (*resource)->size);
+	aga_resource_pack_unlock(pack);
 
-		if(result) return result;
+	if(!result) aga_resource_trace(*resource);
+
+	return result;
+}
+
+enum asys_result aga_resource_prefetch(
+		struct aga_resource_pack* pack, const char* path) {
+
+	enum asys_result result;
+	struct aga_resource* resource;
+
+	if(!pack) return ASYS_RESULT_BAD_PARAM;
+	if(!path) return ASYS_RESULT_BAD_PARAM;
+
+	result = aga_resource_pack_lookup(pack, path, &resource);
+	if(result) return result;
+
+	aga_resource_pack_lock(pack);
+
+	if(resource->data || resource->prefetch != AGA_PREFETCH_NONE) {
+		aga_resource_pack_unlock(pack);
+		return ASYS_RESULT_OK;
 	}
 
-	++(*resource)->refcount;
+	if(pack->threaded) {
+		resource->prefetch = AGA_PREFETCH_QUEUED;
 
-	return ASYS_RESULT_OK;
+		if(pack->prefetch_tail) pack->prefetch_tail->prefetch_next = resource;
+		else pack->prefetch_head = resource;
+
+		pack->prefetch_tail = resource;
+		pack->pending++;
+
+		aga_resource_pack_signal(&pack->queued);
+	}
+	else {
+		/* Without a worker the best we can do is to load it now. */
+		result = aga_resource_load(resource);
+		if(!result && !resource->refcount) aga_resource_lru_push(resource);
+	}
+
+	aga_resource_pack_unlock(pack);
+
+	return result;
 }
 
 enum asys_result aga_resource_stream(
@@ -298,6 +1128,17 @@ enum asys_result aga_resource_seek(
 
 	if(!resource) return ASYS_RESULT_BAD_PARAM;
 
+	if(resource->flags & AGA_RESOURCE_COMPRESSED) {
+		asys_log(
+				__FILE__,
+				"err: Compressed resource `%s' cannot be read as a raw stream",
+				resource->name);
+
+		return ASYS_RESULT_BAD_PARAM;
+	}
+
+	aga_resource_trace(resource);
+
 	offset = (asys_offset_t) (resource->pack->data_offset + resource->offset);
 
 	result = asys_stream_seek(&resource->pack->stream, ASYS_SEEK_SET, offset);
@@ -308,18 +1149,224 @@ enum asys_result aga_resource_seek(
 	return ASYS_RESULT_OK;
 }
 
+enum asys_result aga_resource_read_at(
+		struct aga_resource* resource, asys_size_t offset, void* buffer,
+		asys_size_t count, asys_size_t* read_count) {
+
+	enum asys_result result = ASYS_RESULT_OK;
+
+	struct aga_resource_pack* pack;
+	asys_uchar_t* data;
+	asys_size_t base;
+
+	if(!resource) return ASYS_RESULT_BAD_PARAM;
+	if(!buffer) return ASYS_RESULT_BAD_PARAM;
+
+	pack = resource->pack;
+	base = pack->data_offset + resource->offset;
+
+	aga_resource_trace(resource);
+
+	if(offset > resource->size) offset = resource->size;
+	if(count > resource->size - offset) {
+		count = resource->size - offset;
+		result = ASYS_RESULT_EOF;
+	}
+
+	if(read_count) *read_count = count;
+
+	aga_resource_pack_lock(pack);
+	data = resource->data;
+	aga_resource_pack_unlock(pack);
+
+	/* Resident data can be used as-is, even if it was stored compressed. */
+	if(data) asys_memory_copy(buffer, &data[offset], count);
+	else if(resource->flags & AGA_RESOURCE_COMPRESSED) {
+		asys_log(
+				__FILE__,
+				"err: Compressed resource `%s' must be resident to be read at"
+				" an offset", resource->name);
+
+		return ASYS_RESULT_BAD_PARAM;
+	}
+	else if(pack->map) {
+		enum asys_result bounds = aga_resource_check_bounds(resource);
+		if(bounds) return bounds;
+
+		data = pack->map;
+		asys_memory_copy(buffer, &data[base + offset], count);
+	}
+	else {
+		enum asys_result read;
+
+		read = asys_stream_read_at(
+				&pack->stream, (asys_offset_t) (base + offset), 0, buffer,
+				count);
+
+		if(read) return read;
+	}
+
+	return result;
+}
+
+enum asys_result aga_resource_reader_new(
+		struct aga_resource* resource, struct aga_resource_reader* reader) {
+
+	if(!resource) return ASYS_RESULT_BAD_PARAM;
+	if(!reader) return ASYS_RESULT_BAD_PARAM;
+
+	aga_resource_trace(resource);
+
+	return aga_resource_reader_begin(resource, reader);
+}
+
+/* Tops up the staging buffer -- at most one undecoded byte is carried over. */
+static enum asys_result aga_resource_reader_fill(
+		struct aga_resource_reader* reader) {
+
+	enum asys_result result;
+
+	struct aga_resource* resource = reader->resource;
+	struct aga_resource_pack* pack = resource->pack;
+
+	asys_size_t carry = reader->buffer_end - reader->buffer_start;
+	asys_size_t count = AGA_RESOURCE_READER_BUFFER - carry;
+	asys_offset_t offset;
+
+	if(count > resource->stored - reader->fetched) {
+		count = resource->stored - reader->fetched;
+	}
+
+	if(carry) reader->buffer[0] = reader->buffer[reader->buffer_start];
+
+	offset = (asys_offset_t) (
+			pack->data_offset + resource->offset + reader->fetched);
+
+	result = asys_stream_read_at(
+			reader->stream, offset, 0, &reader->buffer[carry], count);
+
+	if(result) return result;
+
+	reader->fetched += count;
+	reader->buffer_start = 0;
+	reader->buffer_end = carry + count;
+
+	return ASYS_RESULT_OK;
+}
+
+enum asys_result aga_resource_read(
+		struct aga_resource_reader* reader, void* buffer, asys_size_t count,
+		asys_size_t* read_count) {
+
+	enum asys_result result;
+
+	struct aga_resource* resource;
+	struct aga_resource_pack* pack;
+
+	asys_uchar_t* bytes = buffer;
+	asys_size_t base, produced = 0;
+	asys_bool_t short_read = ASYS_FALSE;
+
+	if(!reader) return ASYS_RESULT_BAD_PARAM;
+	if(!buffer) return ASYS_RESULT_BAD_PARAM;
+
+	resource = reader->resource;
+	pack = resource->pack;
+	base = pack->data_offset + resource->offset;
+
+	if(count > resource->size - reader->position) {
+		count = resource->size - reader->position;
+		short_read = ASYS_TRUE;
+	}
+
+	if(!(resource->flags & AGA_RESOURCE_COMPRESSED)) {
+		if(pack->map) {
+			const asys_uchar_t* data = pack->map;
+
+			asys_memory_copy(bytes, &data[base + reader->position], count);
+		}
+		else {
+			asys_offset_t offset = (asys_offset_t) (base + reader->position);
+
+			result = asys_stream_read_at(
+					reader->stream, offset, 0, bytes, count);
+
+			if(result) return result;
+		}
+
+		produced = count;
+	}
+
+	while(produced < count) {
+		const asys_uchar_t* in;
+		asys_size_t available, remaining, made;
+
+		if(pack->map) {
+			in = (const asys_uchar_t*) pack->map + base + reader->fetched;
+			available = resource->stored - reader->fetched;
+		}
+		else {
+			available = reader->buffer_end - reader->buffer_start;
+
+			/* Back-references need both of their bytes at once. */
+			if(available < 2 && reader->fetched < resource->stored) {
+				if((result = aga_resource_reader_fill(reader))) return result;
+
+				available = reader->buffer_end - reader->buffer_start;
+			}
+
+			in = &reader->buffer[reader->buffer_start];
+		}
+
+		remaining = available;
+		made = aga_lz_decode(
+				&reader->lz, &in, &remaining, &bytes[produced],
+				count - produced);
+
+		if(pack->map) reader->fetched += available - remaining;
+		else reader->buffer_start += available - remaining;
+
+		if(!made && remaining == available) {
+			asys_log(
+					__FILE__, "err: Compressed resource `%s' is truncated",
+					resource->name);
+
+			return ASYS_RESULT_BAD_PARAM;
+		}
+
+		produced += made;
+	}
+
+	reader->position += produced;
+	if(read_count) *read_count = produced;
+
+	return short_read ? ASYS_RESULT_EOF : ASYS_RESULT_OK;
+}
+
 enum asys_result aga_resource_aquire(struct aga_resource* res) {
 	if(!res) return ASYS_RESULT_BAD_PARAM;
 
+	aga_resource_pack_lock(res->pack);
+
+	if(!res->refcount && res->data) aga_resource_lru_remove(res);
+
 	++res->refcount;
 
+	aga_resource_pack_unlock(res->pack);
+
 	return ASYS_RESULT_OK;
 }
 
 enum asys_result aga_resource_release(struct aga_resource* res) {
 	if(!res) return ASYS_RESULT_BAD_PARAM;
 
-	if(res->refcount) --res->refcount;
+	aga_resource_pack_lock(res->pack);
+
+	if(res->refcount && !--res->refcount && res->data) {
+		aga_resource_lru_push(res);
+	}
+
+	aga_resource_pack_unlock(res->pack);
 
 	return ASYS_RESULT_OK;
 }
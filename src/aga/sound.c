@@ -134,7 +134,6 @@ enum asys_result aga_sound_device_update(struct aga_sound_device* dev) {
 
 		for(i = 0; i < dev->count; ++i) {
 			struct aga_sound_stream* stream = &dev->streams[i];
-			void* fp;
 			asys_size_t rdsz;
 			asys_bool_t eof = ASYS_FALSE;
 
@@ -145,20 +144,13 @@ enum asys_result aga_sound_device_update(struct aga_sound_device* dev) {
 			 */
 			if(stream->done) continue;
 
-			result = aga_resource_seek(stream->resource, &fp);
-			if(result) return result;
+			result = aga_resource_read_at(
+					stream->resource, stream->offset, dev->scratch, req,
+					&rdsz);
 
-			if(fseek(fp, (long) stream->offset, SEEK_CUR)) {
-				return aga_error_system(__FILE__, "fseek");
-			}
+			if(result == ASYS_RESULT_EOF) eof = ASYS_TRUE;
+			else if(result) return result;
 
-			rdsz = fread(dev->scratch, 1, req, fp);
-			if(rdsz < req) {
-				if(ferror(fp)) {
-					return aga_error_system(__FILE__, "fread");
-				}
-				else eof = ASYS_TRUE;
-			}
 			stream->last_seek = rdsz;
 			stream->offset += rdsz;
 
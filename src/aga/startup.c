@@ -22,6 +22,7 @@ enum asys_result aga_settings_new(
 #ifdef AGA_DEVBUILD
 	opts->compile = ASYS_FALSE;
 	opts->build_file = "agabuild.sgml";
+	opts->trace_file = 0;
 #endif
 	opts->config_file = "aga.sgml";
 	opts->display = 0;
@@ -30,6 +31,7 @@ enum asys_result aga_settings_new(
 	opts->startup_script = "script/main.py.raw";
 	opts->python_path = "script";
 	opts->respack = "agapack.raw";
+	opts->resource_budget = 32 * 1024 * 1024;
 	opts->width = 640;
 	opts->height = 480;
 	opts->title = "Aft Gang Aglay";
@@ -50,13 +52,14 @@ enum asys_result aga_settings_new(
 			"warn: usage:\n"
 			"\t%s [-f respack] [-A dsp] [-D display] [-C dir] [-v] [-h]"
 #ifdef AGA_DEVBUILD
+			" [-t trace]"
 			"\n\t%s -c [-f buildfile] [-C dir] [-v] [-h]"
 #endif
 		;
 
 		int o;
 		while(1) {
-			o = getopt(main_data->argc, main_data->argv, "hcf:s:A:D:C:v");
+			o = getopt(main_data->argc, main_data->argv, "hcf:s:A:D:C:t:v");
 			if(o == -1) break;
 
 			switch(o) {
@@ -107,6 +110,14 @@ enum asys_result aga_settings_new(
 					opts->chdir = optarg;
 					break;
 				}
+#ifdef AGA_DEVBUILD
+				case 't': {
+					if(opts->compile) goto help;
+
+					opts->trace_file = optarg;
+					break;
+				}
+#endif
 				case 'v': {
 					extern int WWW_TraceFlag; /* From libwww. */
 					WWW_TraceFlag = 1;
@@ -142,23 +153,28 @@ enum asys_result aga_settings_parse_config(
 	static const char* height[] = { "Display", "Height" };
 	static const char* mipmap[] = { "Graphics", "MipmapDefault" };
 	static const char* fov[] = { "Display", "FOV" };
+	static const char* budget[] = { "Resource", "Budget" };
 
 	static asys_float_format_buffer_t double_format;
 
 	enum asys_result result;
-	struct asys_stream* stream;
+	struct aga_resource* resource;
 
-	asys_size_t size;
 	aga_config_int_t v;
 	double fv;
 
 	if(!opts) return ASYS_RESULT_BAD_PARAM;
 	if(!pack) return ASYS_RESULT_BAD_PARAM;
 
-	result = aga_resource_stream(pack, opts->config_file, &stream, &size);
+	result = aga_resource_new(pack, opts->config_file, &resource);
 	if(result) return result;
 
-	result = aga_config_new(stream, size, &opts->config);
+	result = aga_config_new_memory(
+			resource->data, resource->size, &opts->config);
+
+	asys_log_result(
+			__FILE__, "aga_resource_release", aga_resource_release(resource));
+
 	if(result) return result;
 
 	result = aga_config_lookup(
@@ -229,6 +245,13 @@ enum asys_result aga_settings_parse_config(
 	asys_log_result(__FILE__, "aga_config_lookup", result);
 	if(!result) opts->fov = (float) fv;
 
+	result = aga_config_lookup(
+			opts->config.children, budget, ASYS_LENGTH(budget),
+			&v, AGA_INTEGER, ASYS_TRUE);
+
+	asys_log_result(__FILE__, "aga_config_lookup", result);
+	if(!result) opts->resource_budget = (asys_size_t) v;
+
 	/* TODO: Put this in a separate function. */
 
 	asys_log(__FILE__, "Loaded startup options:");
@@ -247,6 +270,10 @@ enum asys_result aga_settings_parse_config(
 			__FILE__, "\tResource Pack: %s",
 			asys_string_optional(opts->respack));
 
+	asys_log(
+			__FILE__, "\tResource Budget: " ASYS_NATIVE_ULONG_FORMAT,
+			opts->resource_budget);
+
 	asys_log(
 			__FILE__, "\tAudio Buffer: " ASYS_NATIVE_ULONG_FORMAT,
 			opts->audio_buffer);
@@ -89,7 +89,7 @@ enum asys_result aga_mkmod(struct py_env* env, void** dict) {
 
 			/* Miscellaneous */
 			aga_(getconf), aga_(packlist), aga_(log), aga_(die), aga_(dt),
-			aga_(strsplit),
+			aga_(strsplit), aga_(prefetch), aga_(prefetching),
 
 			/* Objects */
 			aga_(mkobj), aga_(inobj), aga_(putobj), aga_(killobj),
@@ -107,6 +107,8 @@ static struct py_object* agan_mkpack(
 	result = aga_resource_pack_new(opts->respack, pack);
 	if(aga_script_err("aga_resource_pack_new", result)) return 0;
 
+	pack->budget = opts->resource_budget;
+
 	return py_object_incref(PY_NONE);
 }
 
@@ -133,7 +135,7 @@ static struct py_object* agan_dumpobj(
 		return aga_arg_error("dumpobj", "int and string");
 	}
 
-	obj = (void*) py_int_get(objp);
+	if(!(obj = agan_object_arg(objp))) return 0;
 	path = py_string_get(pathp);
 
 	result = agan_getobjconf(obj, &node);
@@ -186,8 +188,7 @@ static struct py_object* agan_dumpobj(
 		result = aga_config_lookup_check(node.children, &model, 1, &n);
 		if(aga_script_err("aga_config_lookup_check", result)) return 0;
 
-		asys_memory_free(n->data.string);
-		n->data.string = asys_string_duplicate(obj->modelpath);
+		n->data.string = aga_config_string(&node, obj->modelpath);
 	}
 
 	{
@@ -263,7 +264,7 @@ static struct py_object* agan_setobjmdl(
 		return aga_arg_error("setobjmdl", "int and string");
 	}
 
-	obj = aga_script_pointer_get(objp);
+	if(!(obj = agan_object_arg(objp))) return 0;
 	path = py_string_get(pathp);
 
 	result = agan_getobjconf(obj, &root);
@@ -277,10 +278,9 @@ static struct py_object* agan_setobjmdl(
 	 * TODO: We don't validate that the conf node is the correct type here nor
 	 * 		 Above.
 	 */
-	asys_memory_free(node->data.string);
-	node->data.string = asys_string_duplicate(path);
+	node->data.string = aga_config_string(&root, path);
 
-	/* TODO: Soft reload object model here. Delete old drawlist etc. */
+	/* TODO: Soft reload object model here. Release old model etc. */
 
 	return py_object_incref(PY_NONE);
 }
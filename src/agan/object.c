@@ -47,20 +47,158 @@ enum asys_result agan_obj_register(struct py_env* env) {
 	return ASYS_RESULT_OK;
 }
 
+/*
+ * The object registry. Slots only ever grow in number -- killed objects have
+ * Their slots threaded onto a free list for reuse.
+ */
+static struct agan_object* agan_objects = 0;
+static asys_size_t agan_objects_count = 0;
+static asys_size_t agan_objects_capacity = 0;
+static asys_size_t agan_objects_free = 0; /* The first free slot plus one. */
+
+static enum asys_result agan_object_new(struct agan_object** out) {
+	struct agan_object* obj;
+	agan_object_handle_t generation = 1;
+	asys_size_t index;
+
+	if(agan_objects_free) {
+		index = agan_objects_free - 1;
+		obj = &agan_objects[index];
+		agan_objects_free = obj->next_free;
+
+		/* Generation zero is skipped so that no handle is zero. */
+		generation = (obj->handle >> AGAN_OBJECT_INDEX_BITS) + 1;
+		if(generation == AGAN_OBJECT_GENERATIONS) generation = 1;
+	}
+	else {
+		if(agan_objects_count == agan_objects_capacity) {
+			asys_size_t capacity = agan_objects_capacity;
+			void* objects;
+
+			if(capacity > AGAN_OBJECT_INDEX_MASK) return ASYS_RESULT_OOM;
+
+			capacity = capacity ? capacity * 2 : 64;
+			objects = asys_memory_reallocate(
+					agan_objects, capacity * sizeof(struct agan_object));
+
+			if(!objects) return ASYS_RESULT_OOM;
+
+			agan_objects = objects;
+			agan_objects_capacity = capacity;
+		}
+
+		index = agan_objects_count++;
+		obj = &agan_objects[index];
+	}
+
+	asys_memory_zero(obj, sizeof(struct agan_object));
+
+	obj->handle = (generation << AGAN_OBJECT_INDEX_BITS) | index;
+	obj->ind = (asys_uint_t) index;
+	obj->live = ASYS_TRUE;
+
+	*out = obj;
+
+	return ASYS_RESULT_OK;
+}
+
+static void agan_object_free(struct agan_object* obj) {
+	obj->live = ASYS_FALSE;
+	obj->next_free = agan_objects_free;
+	agan_objects_free = (asys_size_t) (obj - agan_objects) + 1;
+}
+
+struct agan_object* agan_object_slots(asys_size_t* count) {
+	*count = agan_objects_count;
+	return agan_objects;
+}
+
+struct agan_object* agan_object_get(agan_object_handle_t handle) {
+	struct agan_object* obj;
+	asys_size_t index = handle & AGAN_OBJECT_INDEX_MASK;
+
+	if(index >= agan_objects_count) return 0;
+
+	obj = &agan_objects[index];
+	if(!obj->live || obj->handle != handle) return 0;
+
+	return obj;
+}
+
+struct agan_object* agan_object_arg(struct py_object* arg) {
+	struct agan_object* obj;
+
+	obj = agan_object_get((agan_object_handle_t) py_int_get(arg));
+	if(!obj) {
+		(void) aga_script_err("agan_object_get", ASYS_RESULT_BAD_PARAM);
+		return 0;
+	}
+
+	return obj;
+}
+
+/*
+ * Reads up to three float components of `node' by name, defaulting any which
+ * Are missing.
+ */
+static void agan_conf_floats(
+		struct aga_config_node* node, const char** names, asys_size_t count,
+		float* out, float fallback) {
+
+	struct aga_config_query queries[3];
+	double values[3];
+	asys_size_t i;
+
+	for(i = 0; i < count; ++i) {
+		queries[i].names = &names[i];
+		queries[i].count = 1;
+		queries[i].type = AGA_FLOAT;
+		queries[i].value = &values[i];
+	}
+
+	if(aga_config_lookup_all(node, queries, count)) {
+		for(i = 0; i < count; ++i) out[i] = fallback;
+		return;
+	}
+
+	for(i = 0; i < count; ++i) {
+		out[i] = queries[i].result ? fallback : (float) values[i];
+	}
+}
+
 static asys_bool_t agan_mkobj_trans(
 		struct agan_object* obj, struct aga_config_node* conf) {
 
 	enum asys_result result;
-	const char* path[2];
+	const char* paths[9][2];
+	struct aga_config_query queries[9];
+	double values[9];
 
 	struct py_object* l;
 	struct py_object* o;
 	unsigned i, j;
-	double f;
 
+	/* Kept in `Position/X', `Position/Y'... order to share parent walks. */
 	for(i = 0; i < 3; ++i) {
-		path[0] = agan_conf_components[i];
+		for(j = 0; j < 3; ++j) {
+			struct aga_config_query* query = &queries[i * 3 + j];
 
+			paths[i * 3 + j][0] = agan_conf_components[i];
+			paths[i * 3 + j][1] = agan_xyz[j];
+
+			query->names = paths[i * 3 + j];
+			query->count = ASYS_LENGTH(paths[0]);
+			query->type = AGA_FLOAT;
+			query->value = &values[i * 3 + j];
+		}
+	}
+
+	result = aga_config_lookup_all(
+			conf->children, queries, ASYS_LENGTH(queries));
+
+	if(aga_script_err("aga_config_lookup_all", result)) return ASYS_TRUE;
+
+	for(i = 0; i < 3; ++i) {
 		l = py_dict_lookup(obj->transform, agan_trans_components[i]);
 		if(!l) {
 			py_error_set_key();
@@ -68,13 +206,9 @@ static asys_bool_t agan_mkobj_trans(
 		}
 
 		for(j = 0; j < 3; ++j) {
-			path[1] = agan_xyz[j];
+			double f = values[i * 3 + j];
 
-			result = aga_config_lookup(
-					conf->children, path, ASYS_LENGTH(path), &f, AGA_FLOAT,
-					ASYS_FALSE);
-
-			if(result) f = 0.0f;
+			if(queries[i * 3 + j].result) f = 0.0f;
 
 			if(!(o = py_float_new(f))) {
 				py_error_set_nomem();
@@ -89,278 +223,915 @@ static asys_bool_t agan_mkobj_trans(
 }
 
 static void agan_mkobj_extent(
-		struct agan_object* obj, struct aga_config_node* conf) {
+		struct agan_object* obj, struct aga_resource* res) {
 
-	static const char* min_attr[] = { "MinX", "MinY", "MinZ" };
-	static const char* max_attr[] = { "MaxX", "MaxY", "MaxZ" };
+	asys_memory_copy(obj->min_extent, &res->extent[0], sizeof(float[3]));
+	asys_memory_copy(obj->max_extent, &res->extent[3], sizeof(float[3]));
+}
 
-	float (*min)[3] = &obj->min_extent;
-	float (*max)[3] = &obj->max_extent;
+/* The parts of an indexed (version 3) model -- see `aga_model_header'. */
+struct agan_indexed {
+	const struct aga_model_header* header;
+	const void* vertices;
+	const void* indices;
+	asys_bool_t quantised;
+};
 
-	asys_size_t i;
+static asys_uint_t agan_indexed_get(
+		const struct agan_indexed* model, asys_size_t i) {
 
-	for(i = 0; i < 3; ++i) {
-		double v;
+	if(model->header->index_size == 2) {
+		return ((const unsigned short*) model->indices)[i];
+	}
+	else return ((const asys_uint_t*) model->indices)[i];
+}
 
-		if(aga_config_lookup(conf, &min_attr[i], 1, &v, AGA_FLOAT, ASYS_FALSE)) {
-			(*min)[i] = 0.0f;
-		}
-		else (*min)[i] = (float) v;
+/*
+ * Lays out and validates an indexed model. Indices are range checked up-front
+ * As neither list build nor array draws can back out part way through.
+ */
+static asys_bool_t agan_indexed_view(
+		struct aga_resource* res, const char* path, struct agan_indexed* out) {
 
-		if(aga_config_lookup(conf, &max_attr[i], 1, &v, AGA_FLOAT, ASYS_FALSE)) {
-			(*max)[i] = 0.0f;
+	const struct aga_model_header* header = res->data;
+	asys_size_t i, size, vertex_size;
+
+	if(res->size < sizeof(struct aga_model_header)) {
+		asys_log(__FILE__, "err: Model `%s' is malformed", path);
+		return aga_script_err("agan_indexed_view", ASYS_RESULT_BAD_PARAM);
+	}
+
+	out->header = header;
+	out->vertices = header + 1;
+	out->quantised = !!(header->flags & AGA_MODEL_QUANTISED);
+
+	if(out->quantised) {
+		vertex_size = sizeof(struct aga_model_packed_vertex);
+	}
+	else vertex_size = sizeof(struct aga_model_vertex);
+
+	/* Vertex data is padded to keep the indices aligned. */
+	size = sizeof(struct aga_model_header);
+	size += AGA_MODEL_ALIGN(header->vertices * vertex_size);
+	out->indices = (const asys_uchar_t*) res->data + size;
+	size += header->indices * header->index_size;
+
+	if(res->size < size ||
+		(header->index_size != 2 && header->index_size != 4)) {
+
+		asys_log(__FILE__, "err: Model `%s' is malformed", path);
+		return aga_script_err("agan_indexed_view", ASYS_RESULT_BAD_PARAM);
+	}
+
+	for(i = 0; i < header->indices; ++i) {
+		if(agan_indexed_get(out, i) >= header->vertices) {
+			asys_log(
+					__FILE__, "err: Model `%s' has out of range indices",
+					path);
+
+			return aga_script_err("agan_indexed_view", ASYS_RESULT_BAD_PARAM);
 		}
-		else (*max)[i] = (float) v;
 	}
+
+	return ASYS_FALSE;
 }
 
 /*
- * TODO: Object models should be able to specify a billboard texture for auto
- * 		 LOD -- especially when we have our zoning/distance culling system.
+ * Models are shared between all objects using the same model path. Where
+ * Built with `AGA_DISPLAY_LISTS' a model's geometry is compiled into a list
+ * On load. Otherwise it is drawn from client-side vertex arrays which point
+ * Straight into the model's resource, which is held for as long as the model
+ * Is, except for quantised models which are expanded to floats on load.
  */
-static asys_bool_t agan_mkobj_model(
-		struct py_env* env, struct agan_object* obj,
-		struct aga_config_node* conf, struct aga_resource_pack* pack,
-		const char* objpath) {
+struct agan_model {
+	char* path;
+	asys_size_t refcount;
 
-	static const char* model = "Model";
-	static const char* texture = "Texture";
-	static const char* filter = "Filter";
-	static const char* mipmap = "Mipmap";
+	/* Version 1 models carry their own vertex colours. */
+	asys_bool_t coloured;
 
-	struct aga_settings* settings = AGA_GET_USERDATA(env)->opts;
+#ifdef AGA_DISPLAY_LISTS
+	GLuint list;
+#else
+	struct aga_resource* res;
+	struct aga_model_vertex* expanded;
+
+	GLsizei stride;
+	const float* uv;
+	const float* norm;
+	const float* pos;
+	const float* col;
+
+	GLenum primitive;
+	const void* indices; /* Drawn as arrays where there are none. */
+	GLenum index_type;
+	GLsizei count;
+#endif
 
-	enum asys_result result;
+	struct agan_model* next;
+};
 
-	struct aga_resource* res;
-	unsigned mode = GL_COMPILE;
-	char* model_path;
-	char* texture_path;
+static struct agan_model* agan_models = 0;
+
+#ifdef AGA_DISPLAY_LISTS
+/* Emits a validated indexed (version 3) model into the list. */
+static void agan_model_list_indexed(const struct agan_indexed* model) {
+	const struct aga_model_header* header = model->header;
+	asys_size_t i;
 
-	/* TODO: Delete lists in error conditions. */
-	obj->drawlist = glGenLists(1);
-	if(aga_script_gl_err("glGenLists")) return 0;
+	if(header->flags & AGA_MODEL_STRIP) glBegin(GL_TRIANGLE_STRIP);
+	else glBegin(GL_TRIANGLES);
+
+	for(i = 0; i < header->indices; ++i) {
+		asys_uint_t index = agan_indexed_get(model, i);
+
+		if(model->quantised) {
+			const struct aga_model_packed_vertex* vertex;
+			const float* scale = header->scale;
+			const float* bias = header->bias;
+
+			vertex = (const struct aga_model_packed_vertex*) model->vertices;
+			vertex += index;
+
+			glTexCoord2f(
+					bias[0] + scale[0] * vertex->uv[0],
+					bias[1] + scale[1] * vertex->uv[1]);
+
+			glNormal3bv((const GLbyte*) vertex->norm);
+
+			glVertex3f(
+					bias[2] + scale[2] * vertex->pos[0],
+					bias[3] + scale[3] * vertex->pos[1],
+					bias[4] + scale[4] * vertex->pos[2]);
+		}
+		else {
+			const struct aga_model_vertex* vertex;
+
+			vertex = (const struct aga_model_vertex*) model->vertices;
+			vertex += index;
+
+			glTexCoord2fv(vertex->uv);
+			glNormal3fv(vertex->norm);
+			glVertex3fv(vertex->pos);
+		}
+	}
+
+	glEnd();
+}
+
+/* Emits a vertex soup (version 1 or 2) model into the list. */
+static void agan_model_list_soup(
+		struct aga_resource* res, asys_bool_t coloured) {
+
+	const struct aga_vertex* vertices = res->data;
+	asys_size_t i, count;
+
+	/* This leaves off the model tail. */
+	count = res->size / sizeof(struct aga_vertex);
+
+	glBegin(GL_TRIANGLES);
+
+	for(i = 0; i < count; ++i) {
+		const struct aga_vertex* vert = &vertices[i];
+
+		if(coloured) glColor4fv(vert->col);
+
+		glTexCoord2fv(vert->uv);
+		glNormal3fv(vert->norm);
+		glVertex3fv(vert->pos);
+	}
+
+	glEnd();
+}
+
+static asys_bool_t agan_model_compile(
+		struct agan_model* model, struct aga_resource* res,
+		aga_config_int_t ver, const char* path) {
+
+	struct agan_indexed view;
+	unsigned mode = GL_COMPILE;
 
 #ifndef NDEBUG
 	mode = GL_COMPILE_AND_EXECUTE;
 #endif
 
+	/* Validation happens up-front as we can't back out during list build. */
+	if(ver >= AGA_MODEL_INDEXED && agan_indexed_view(res, path, &view)) {
+		return ASYS_TRUE;
+	}
+
+	model->list = glGenLists(1);
+	if(aga_script_gl_err("glGenLists")) return ASYS_TRUE;
+
 	/*
 	 * TODO: We could batch chunks of static scene geometry together into one
 	 * 		 Large list during scene build once we have a more cohesive system
 	 * 		 In-place.
 	 */
+	glNewList(model->list, mode);
+	if(aga_script_gl_err("glNewList")) return ASYS_TRUE;
+
+	if(ver >= AGA_MODEL_INDEXED) agan_model_list_indexed(&view);
+	else agan_model_list_soup(res, model->coloured);
+
+	glEndList();
+	if(aga_script_gl_err("glEndList")) return ASYS_TRUE;
+
+	return ASYS_FALSE;
+}
+#else
+static asys_bool_t agan_model_indexed(
+		struct agan_model* model, const char* path) {
+
+	struct agan_indexed view;
+	const struct aga_model_header* header;
+	asys_size_t i;
+
+	if(agan_indexed_view(model->res, path, &view)) return ASYS_TRUE;
+
+	header = view.header;
+
+	if(view.quantised) {
+		const struct aga_model_packed_vertex* packed = view.vertices;
+		const float* scale = header->scale;
+		const float* bias = header->bias;
+
+		model->expanded = asys_memory_allocate(
+				header->vertices * sizeof(struct aga_model_vertex));
+
+		if(!model->expanded && header->vertices) {
+			return aga_script_err("asys_memory_allocate", ASYS_RESULT_OOM);
+		}
+
+		for(i = 0; i < header->vertices; ++i) {
+			struct aga_model_vertex* vertex = &model->expanded[i];
+			asys_size_t j;
+
+			vertex->uv[0] = bias[0] + scale[0] * packed[i].uv[0];
+			vertex->uv[1] = bias[1] + scale[1] * packed[i].uv[1];
+
+			for(j = 0; j < 3; ++j) {
+				vertex->pos[j] = bias[2 + j] + scale[2 + j] * packed[i].pos[j];
+				vertex->norm[j] = (2.0f * packed[i].norm[j] + 1.0f) / 255.0f;
+			}
+		}
+
+		view.vertices = model->expanded;
+	}
+
+	model->stride = sizeof(struct aga_model_vertex);
+	model->uv = ((const struct aga_model_vertex*) view.vertices)->uv;
+	model->norm = ((const struct aga_model_vertex*) view.vertices)->norm;
+	model->pos = ((const struct aga_model_vertex*) view.vertices)->pos;
+
+	if(header->flags & AGA_MODEL_STRIP) model->primitive = GL_TRIANGLE_STRIP;
+	else model->primitive = GL_TRIANGLES;
+
+	model->indices = view.indices;
+	if(header->index_size == 2) model->index_type = GL_UNSIGNED_SHORT;
+	else model->index_type = GL_UNSIGNED_INT;
+	model->count = (GLsizei) header->indices;
+
+	return ASYS_FALSE;
+}
+
+static void agan_model_soup(struct agan_model* model) {
+	const struct aga_vertex* vertices = model->res->data;
+
+	model->stride = sizeof(struct aga_vertex);
+	model->uv = vertices->uv;
+	model->norm = vertices->norm;
+	model->pos = vertices->pos;
+	if(model->coloured) model->col = vertices->col;
+
+	model->primitive = GL_TRIANGLES;
+
+	/* This leaves off the model tail. */
+	model->count = (GLsizei) (model->res->size / sizeof(struct aga_vertex));
+}
+#endif
+
+static enum asys_result agan_model_release(struct agan_model* model) {
+	enum asys_result result = ASYS_RESULT_OK;
+	struct agan_model** it;
+
+	if(--model->refcount) return ASYS_RESULT_OK;
+
+	for(it = &agan_models; *it; it = &(*it)->next) {
+		if(*it == model) {
+			*it = model->next;
+			break;
+		}
+	}
+
+#ifdef AGA_DISPLAY_LISTS
+	if(model->list) {
+		glDeleteLists(model->list, 1);
+		result = aga_error_gl(__FILE__, "glDeleteLists");
+	}
+#else
+	if(model->res) result = aga_resource_release(model->res);
+
+	asys_memory_free(model->expanded);
+#endif
+
+	asys_memory_free(model->path);
+	asys_memory_free(model);
+
+	return result;
+}
+
+/* Finds the shared model for `path' or loads it if it isn't resident. */
+static asys_bool_t agan_model_new(
+		struct aga_resource_pack* pack, const char* path, aga_config_int_t ver,
+		struct agan_model** out) {
+
+	enum asys_result result;
+
+	struct agan_model* model;
+	struct aga_resource* res;
+
+	for(model = agan_models; model; model = model->next) {
+		if(asys_string_equal(model->path, path)) {
+			model->refcount++;
+			*out = model;
+
+			return ASYS_FALSE;
+		}
+	}
+
+	if(!(model = asys_memory_allocate_zero(1, sizeof(struct agan_model)))) {
+		return aga_script_err("asys_memory_allocate_zero", ASYS_RESULT_OOM);
+	}
+
+	model->refcount = 1;
+	model->coloured = (ver == 1);
+	model->next = agan_models;
+	agan_models = model;
+
+	if(!(model->path = asys_string_duplicate(path))) {
+		(void) aga_script_err("asys_string_duplicate", ASYS_RESULT_OOM);
+		goto cleanup;
+	}
+
 	/*
-	 * TODO: Advice appears to be to keep a list per-model rather than
-	 * 		 Per-object and to retexture/material as necessary for instances.
-	 * 		 We can probably balance this between instanced and non-instanced
-	 * 		 Draw.
+	 * The whole model is brought in at once -- in one read, or none at all
+	 * Where the pack is mapped -- rather than a read per vertex.
 	 */
-	glNewList(obj->drawlist, mode);
-	if(aga_script_gl_err("glNewList")) return 0;
+	result = aga_resource_new(pack, path, &res);
+	if(aga_script_err("aga_resource_new", result)) goto cleanup;
 
+#ifdef AGA_DISPLAY_LISTS
 	{
-		asys_bool_t do_mips, tex_filter;
-		aga_config_int_t v;
+		/* The geometry lives in the list from here on. */
+		asys_bool_t failed = agan_model_compile(model, res, ver, path);
+
+		result = aga_resource_release(res);
+		if(aga_script_err("aga_resource_release", result)) goto cleanup;
+
+		if(failed) goto cleanup;
+	}
+#else
+	model->res = res;
 
-		result = aga_config_lookup(
-				conf->children, &filter, 1, &v, AGA_INTEGER, ASYS_FALSE);
-		if(result) v = 1;
-		tex_filter = !!v;
+	if(ver >= AGA_MODEL_INDEXED) {
+		if(agan_model_indexed(model, path)) goto cleanup;
+	}
+	else agan_model_soup(model);
+#endif
 
-		result = aga_config_lookup(
-				conf->children, &mipmap, 1, &v, AGA_INTEGER, ASYS_FALSE);
+	*out = model;
 
-		if(result) v = settings->mipmap_default;
-		do_mips = !!v;
+	return ASYS_FALSE;
 
-		result = aga_config_lookup(
-				conf->children, &texture, 1, &texture_path, AGA_PATH,
-				ASYS_FALSE);
+	cleanup: {
+		asys_log_result(
+				__FILE__, "agan_model_release", agan_model_release(model));
 
-		if(result) {
-			/* TODO: Does this handle this case gracefully. */
-			asys_log(
-					__FILE__, "warn: Object `%s' is missing a texture entry",
-					objpath);
+		return ASYS_TRUE;
+	}
+}
+
+#ifdef AGA_DISPLAY_LISTS
+static asys_bool_t agan_model_draw(const struct agan_model* model) {
+	glCallList(model->list);
+	return aga_script_gl_err("glCallList");
+}
+#else
+static asys_bool_t agan_model_draw(const struct agan_model* model) {
+	asys_bool_t failed = ASYS_TRUE;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if(aga_script_gl_err("glEnableClientState")) return ASYS_TRUE;
+
+	glEnableClientState(GL_NORMAL_ARRAY);
+	if(aga_script_gl_err("glEnableClientState")) goto cleanup;
+
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	if(aga_script_gl_err("glEnableClientState")) goto cleanup;
+
+	if(model->col) {
+		glEnableClientState(GL_COLOR_ARRAY);
+		if(aga_script_gl_err("glEnableClientState")) goto cleanup;
+
+		glColorPointer(4, GL_FLOAT, model->stride, model->col);
+		if(aga_script_gl_err("glColorPointer")) goto cleanup;
+	}
+
+	glTexCoordPointer(2, GL_FLOAT, model->stride, model->uv);
+	if(aga_script_gl_err("glTexCoordPointer")) goto cleanup;
+
+	glNormalPointer(GL_FLOAT, model->stride, model->norm);
+	if(aga_script_gl_err("glNormalPointer")) goto cleanup;
+
+	glVertexPointer(3, GL_FLOAT, model->stride, model->pos);
+	if(aga_script_gl_err("glVertexPointer")) goto cleanup;
+
+	if(model->indices) {
+		glDrawElements(
+				model->primitive, model->count, model->index_type,
+				model->indices);
+
+		if(aga_script_gl_err("glDrawElements")) goto cleanup;
+	}
+	else {
+		glDrawArrays(model->primitive, 0, model->count);
+		if(aga_script_gl_err("glDrawArrays")) goto cleanup;
+	}
+
+	failed = ASYS_FALSE;
+
+	cleanup: {
+		/* Other draws expect client arrays to be off. */
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_NORMAL_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		if(aga_script_gl_err("glDisableClientState")) return ASYS_TRUE;
+
+		return failed;
+	}
+}
+#endif
+
+struct agan_image_format {
+	GLint internal;
+	GLenum format;
+	GLenum type;
+	asys_size_t size; /* Bytes per texel. */
+};
+
+/* Indexed by `aga_image_format'. */
+static const struct agan_image_format agan_image_formats[] = {
+		{ 4, GL_RGBA, GL_UNSIGNED_BYTE, 4 },
+		{ 3, GL_RGB, GL_UNSIGNED_BYTE, 3 },
+		{ 1, GL_LUMINANCE, GL_UNSIGNED_BYTE, 1 },
+		{ 2, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, 2 },
+		{ GL_RGBA4, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, 2 },
+		{ GL_RGB5_A1, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, 2 },
+		{ GL_RGB5, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2 }
+};
+
+/* Packed pixel types arrived in GL 1.2. */
+static asys_bool_t agan_packed_pixels(void) {
+	static const char* version = 0;
+
+	if(!version) {
+		if(!(version = (const char*) glGetString(GL_VERSION))) {
+			(void) aga_script_gl_err("glGetString");
+			return ASYS_FALSE;
 		}
-		else {
-			static const char* width = "Width";
+	}
 
-			aga_config_int_t w, h;
+	return !(version[0] == '1' && version[1] == '.' && version[2] < '2');
+}
 
-			/*
-			 * TODO: "Just trusting" that this make/release pattern is safe to
-			 * 		 Avoid leaks is unclear and unfriendly to non-maintainers.
-			 * 		 We probably need better lifetime/cleanup etiquette and
-			 * 		 Helper code.
-			 */
+/*
+ * Widens packed texels to 8 bits per channel for implementations without
+ * Packed pixel types -- the texture is still stored in the packed format.
+ */
+static void agan_unpack_texels(
+		const unsigned short* in, asys_size_t count, GLenum type,
+		asys_uchar_t* out) {
 
-			/*
-			 * TODO: Handle missing textures etc. gracefully - default/
-			 * 		 Procedural resources?
-			 */
-			/*
-			 * TODO: Way to deliberately sweep resources once a certain
-			 * 		 Resource type memory cap is reached? Super big RAM spike
-			 * 		 When a scene loads all of these. We could make decref on
-			 * 		 A resource trigger a sweep if the global resource ceiling
-			 * 		 Is close to being reached and warn if we are still close
-			 * 		 To it.
-			 */
-			result = aga_resource_new(pack, texture_path, &res);
-			if(aga_script_err("aga_resource_new", result)) return ASYS_TRUE;
+	asys_size_t i;
 
-			result = aga_resource_release(res);
-			if(aga_script_err("aga_resource_release", result)) {
-				return ASYS_TRUE;
-			}
+	for(i = 0; i < count; ++i) {
+		asys_uint_t t = in[i];
+
+		switch(type) {
+			default: break;
 
-			result = aga_config_lookup(
-					res->config, &width, 1, &w, AGA_INTEGER, ASYS_FALSE);
-			if(result) {
-				/* TODO: Default conf values as part of the API. */
-				asys_log(__FILE__, "warn: Texture `%s' is missing dimensions");
-				w = 0;
-				h = 0;
+			case GL_UNSIGNED_SHORT_4_4_4_4: {
+				*out++ = (asys_uchar_t) (((t >> 12) & 0xF) * 17);
+				*out++ = (asys_uchar_t) (((t >> 8) & 0xF) * 17);
+				*out++ = (asys_uchar_t) (((t >> 4) & 0xF) * 17);
+				*out++ = (asys_uchar_t) ((t & 0xF) * 17);
+
+				break;
 			}
-			else h = (int) (res->size / (asys_size_t) (4 * w));
 
-			/*
-			 * TODO: Non-alpha textures for more effective use of GPU memory
-			 * 		 And turning off transparency auto-disables alpha channel.
-			 * 		 `glPolygonStipple' can be used for fake transparency.
-			 */
-			if(do_mips) {
-				gluBuild2DMipmaps(
-						GL_TEXTURE_2D, 4, (int) w, (int) h, GL_RGBA,
-						GL_UNSIGNED_BYTE, res->data);
-				/*
-				 * TODO: Script land can probably handle lots of GL errors like
-				 * 		 This relatively gracefully (i.e. allow the user code
-				 * 		 To go further without needing try-catch hell).
-				 * 		 Especially in functions like this which aren't
-				 * 		 Supposed to be run every frame.
-				 */
-				if(aga_script_gl_err("gluBuild2DMipmaps")) return ASYS_TRUE;
+			case GL_UNSIGNED_SHORT_5_5_5_1: {
+				*out++ = (asys_uchar_t) (((t >> 11) & 0x1F) * 255 / 31);
+				*out++ = (asys_uchar_t) (((t >> 6) & 0x1F) * 255 / 31);
+				*out++ = (asys_uchar_t) (((t >> 1) & 0x1F) * 255 / 31);
+				*out++ = (asys_uchar_t) ((t & 1) * 255);
+
+				break;
 			}
-			else {
-				glTexImage2D(
-						GL_TEXTURE_2D, 0, 4, (int) w, (int) h, 0, GL_RGBA,
-						GL_UNSIGNED_BYTE, res->data);
 
-				if(aga_script_gl_err("glTexImage2D")) return ASYS_TRUE;
+			case GL_UNSIGNED_SHORT_5_6_5: {
+				*out++ = (asys_uchar_t) (((t >> 11) & 0x1F) * 255 / 31);
+				*out++ = (asys_uchar_t) (((t >> 5) & 0x3F) * 255 / 63);
+				*out++ = (asys_uchar_t) ((t & 0x1F) * 255 / 31);
+
+				break;
 			}
+		}
+	}
+}
+
+/*
+ * Uploads a mipmapped (version 1) image -- see `aga_image_header'. Levels too
+ * Large for the implementation are skipped so that the chain starts at the
+ * Largest one which fits.
+ */
+static asys_bool_t agan_mkobj_levels(
+		struct aga_resource* res, asys_bool_t do_mips, const char* path) {
+
+	const struct aga_image_header* header = res->data;
+	const asys_uchar_t* data = (const asys_uchar_t*) (header + 1);
+
+	const struct agan_image_format* format;
+	asys_uchar_t* unpacked = 0;
+
+	asys_size_t offset = 0, size, i;
+	asys_uint_t width, height;
+	GLint max, level = 0;
+
+	asys_bool_t failed = ASYS_TRUE;
+
+	if(res->size < sizeof(struct aga_image_header) ||
+		header->format >= ASYS_LENGTH(agan_image_formats)) {
+
+		asys_log(__FILE__, "err: Texture `%s' is malformed", path);
+		return aga_script_err("agan_mkobj_levels", ASYS_RESULT_BAD_PARAM);
+	}
+
+	format = &agan_image_formats[header->format];
+
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max);
+	if(aga_script_gl_err("glGetIntegerv")) return ASYS_TRUE;
+
+	/* Levels are tightly packed. */
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if(aga_script_gl_err("glPixelStorei")) return ASYS_TRUE;
 
-			{
-				/* TODO: `ScaleTex' for stretch vs. tile. */
-				int mag = tex_filter ? GL_LINEAR : GL_NEAREST;
-				int min;
+	width = header->width;
+	height = header->height;
+
+	for(i = 0; i < header->levels; ++i) {
+		const void* texels = &data[offset];
+		GLenum type = format->type;
+		GLenum layout = format->format;
+
+		size = format->size * (asys_size_t) width * (asys_size_t) height;
+
+		if(offset + size > res->size - sizeof(struct aga_image_header)) {
+			asys_log(__FILE__, "err: Texture `%s' is malformed", path);
+			(void) aga_script_err("agan_mkobj_levels", ASYS_RESULT_BAD_PARAM);
+			goto cleanup;
+		}
 
-				if(do_mips) {
-					min = tex_filter ?
-							GL_LINEAR_MIPMAP_LINEAR :
-							GL_NEAREST_MIPMAP_NEAREST;
+		if(width <= (asys_uint_t) max && height <= (asys_uint_t) max) {
+			if(format->type != GL_UNSIGNED_BYTE && !agan_packed_pixels()) {
+				/* The first level uploaded is the largest. */
+				if(!unpacked) {
+					unpacked = asys_memory_allocate(4 * width * height);
+					if(!unpacked) {
+						(void) aga_script_err(
+								"asys_memory_allocate", ASYS_RESULT_OOM);
+
+						goto cleanup;
+					}
 				}
-				else min = mag;
 
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min);
-				if(aga_script_gl_err("glTexParameteri")) return ASYS_TRUE;
+				agan_unpack_texels(
+						texels, width * height, format->type, unpacked);
 
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag);
-				if(aga_script_gl_err("glTexParameteri")) return ASYS_TRUE;
+				texels = unpacked;
+				type = GL_UNSIGNED_BYTE;
 			}
 
-			asys_memory_free(texture_path);
+			glTexImage2D(
+					GL_TEXTURE_2D, level++, format->internal, (int) width,
+					(int) height, 0, layout, type, texels);
+
+			if(aga_script_gl_err("glTexImage2D")) goto cleanup;
+
+			if(!do_mips) break;
 		}
 
-		result = aga_config_lookup(
-				conf->children, &model, 1, &model_path, AGA_PATH, ASYS_FALSE);
+		offset += size;
 
-		if(result) {
-			asys_log(
-					__FILE__, "warn: Object `%s' is missing a model entry",
-					objpath);
+		if(width > 1) width /= 2;
+		if(height > 1) height /= 2;
+	}
+
+	failed = ASYS_FALSE;
+
+	cleanup: {
+		asys_memory_free(unpacked);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		if(aga_script_gl_err("glPixelStorei")) return ASYS_TRUE;
+
+		return failed;
+	}
+}
+
+/*
+ * Textures are shared as texture objects between all objects using the same
+ * Image with the same sampling -- filtering and mipmapping are part of the
+ * Texture object's state so are part of the key.
+ */
+struct agan_texture {
+	char* path;
+	asys_size_t refcount;
+
+	asys_bool_t do_mips;
+	asys_bool_t tex_filter;
+
+	GLuint name;
+
+	struct agan_texture* next;
+};
+
+static struct agan_texture* agan_textures = 0;
+
+static enum asys_result agan_texture_release(struct agan_texture* texture) {
+	enum asys_result result = ASYS_RESULT_OK;
+	struct agan_texture** it;
+
+	if(--texture->refcount) return ASYS_RESULT_OK;
+
+	for(it = &agan_textures; *it; it = &(*it)->next) {
+		if(*it == texture) {
+			*it = texture->next;
+			break;
 		}
-		else {
-			static const char* version = "Version";
+	}
 
-			struct aga_vertex vert;
-			struct asys_stream* stream;
-			asys_size_t i, len;
-			aga_config_int_t ver;
+	if(texture->name) {
+		glDeleteTextures(1, &texture->name);
+		result = aga_error_gl(__FILE__, "glDeleteTextures");
+	}
 
-			asys_memory_free(obj->modelpath);
-			if(!(obj->modelpath = asys_string_duplicate(model_path))) {
-				py_error_set_nomem();
-				return 0;
-			}
+	asys_memory_free(texture->path);
+	asys_memory_free(texture);
 
-			result = aga_resource_pack_lookup(pack, model_path, &res);
-			if(aga_script_err("aga_resource_pack_lookup", result)) {
-				asys_log(
-						__FILE__, "err: Failed to find resource `%s'",
-						model_path);
+	return result;
+}
 
-				return ASYS_TRUE;
-			}
+static asys_bool_t agan_texture_upload(
+		struct aga_resource* res, asys_bool_t do_mips, const char* path) {
 
-			agan_mkobj_extent(obj, res->config);
+	aga_config_int_t w, h;
 
-			asys_memory_free(model_path);
+	/*
+	 * Images built with their mip chain are uploaded as-is, which spares
+	 * Rescaling and filtering them on every load.
+	 */
+	if(res->version >= AGA_IMAGE_MIPMAPPED) {
+		return agan_mkobj_levels(res, do_mips, path);
+	}
 
-			result = aga_config_lookup(
-					res->config, &version, 1, &ver, AGA_INTEGER, ASYS_FALSE);
-			if(result) ver = 1;
+	if(!(w = res->width)) {
+		/* TODO: Default conf values as part of the API. */
+		asys_log(__FILE__, "warn: Texture `%s' is missing dimensions", path);
+		w = 0;
+		h = 0;
+	}
+	else h = (int) (res->size / (asys_size_t) (4 * w));
 
-			result = aga_resource_seek(res, &stream);
-			/* TODO: We can't return during list build! */
-			if(aga_script_err("aga_resource_stream", result)) return ASYS_TRUE;
-			len = res->size;
+	/*
+	 * TODO: Turning off transparency should auto-disable the Alpha channel.
+	 * 		 `glPolygonStipple' can be used for fake transparency.
+	 */
+	if(do_mips) {
+		gluBuild2DMipmaps(
+				GL_TEXTURE_2D, 4, (int) w, (int) h, GL_RGBA, GL_UNSIGNED_BYTE,
+				res->data);
+		/*
+		 * TODO: Script land can probably handle lots of GL errors like this
+		 * 		 Relatively gracefully (i.e. allow the user code to go further
+		 * 		 Without needing try-catch hell). Especially in functions like
+		 * 		 This which aren't supposed to be run every frame.
+		 */
+		if(aga_script_gl_err("gluBuild2DMipmaps")) return ASYS_TRUE;
+	}
+	else {
+		glTexImage2D(
+				GL_TEXTURE_2D, 0, 4, (int) w, (int) h, 0, GL_RGBA,
+				GL_UNSIGNED_BYTE, res->data);
 
-			glBegin(GL_TRIANGLES);
-			/* if(aga_script_gl_err("glBegin")) return 0; */
+		if(aga_script_gl_err("glTexImage2D")) return ASYS_TRUE;
+	}
 
-			for(i = 0; i < len; i += sizeof(vert)) {
-				result = asys_stream_read(
-						stream, 0, &vert, sizeof(struct aga_vertex));
+	return ASYS_FALSE;
+}
 
-				if(aga_script_err("asys_stream_read", result)) {
-					return ASYS_TRUE;
-				}
+/*
+ * Finds the shared texture for `path' and the given sampling or uploads it
+ * If there isn't one.
+ */
+static asys_bool_t agan_texture_new(
+		struct aga_resource_pack* pack, const char* path, asys_bool_t do_mips,
+		asys_bool_t tex_filter, struct agan_texture** out) {
 
-				/*
-				 * Models from v2.1.0 and below respected model vertex
-				 * Colouration.
-				 */
-				if(ver == 2) {
-					asys_uchar_t r = (obj->ind >> (2 * 8)) & 0xFF;
-					asys_uchar_t g = (obj->ind >> (1 * 8)) & 0xFF;
-					asys_uchar_t b = (obj->ind >> (0 * 8)) & 0xFF;
-					glColor3ub(r, g, b);
-				}
-				else {
-					AGA_DEPRECATED_IMPL(
-							"Loading Version 1 model data is deprecated");
+	enum asys_result result;
 
-					glColor4fv(vert.col);
-				}
+	struct agan_texture* texture;
+	struct aga_resource* res;
 
-				glTexCoord2fv(vert.uv);
-				/* if(aga_script_gl_err("glTexCoord2fv")) return ASYS_TRUE; */
-				glNormal3fv(vert.norm);
-				/* if(aga_script_gl_err("glNormal3fv")) return ASYS_TRUE; */
-				glVertex3fv(vert.pos);
-				/* if(aga_script_gl_err("glVertex3fv")) return ASYS_TRUE; */
-			}
+	/* TODO: `ScaleTex' for stretch vs. tile. */
+	int mag = tex_filter ? GL_LINEAR : GL_NEAREST;
+	int min;
 
-			glEnd();
-			if(aga_script_gl_err("glEnd")) return 0;
+	for(texture = agan_textures; texture; texture = texture->next) {
+		if(texture->do_mips == do_mips && texture->tex_filter == tex_filter &&
+			asys_string_equal(texture->path, path)) {
+
+			texture->refcount++;
+			*out = texture;
+
+			return ASYS_FALSE;
 		}
 	}
 
-	glEndList();
-	if(aga_script_gl_err("glEndList")) return 0;
+	texture = asys_memory_allocate_zero(1, sizeof(struct agan_texture));
+	if(!texture) {
+		return aga_script_err("asys_memory_allocate_zero", ASYS_RESULT_OOM);
+	}
+
+	texture->refcount = 1;
+	texture->do_mips = do_mips;
+	texture->tex_filter = tex_filter;
+	texture->next = agan_textures;
+	agan_textures = texture;
+
+	if(!(texture->path = asys_string_duplicate(path))) {
+		(void) aga_script_err("asys_string_duplicate", ASYS_RESULT_OOM);
+		goto cleanup;
+	}
+
+	glGenTextures(1, &texture->name);
+	if(aga_script_gl_err("glGenTextures")) goto cleanup;
+
+	glBindTexture(GL_TEXTURE_2D, texture->name);
+	if(aga_script_gl_err("glBindTexture")) goto cleanup;
+
+	/*
+	 * TODO: Handle missing textures etc. gracefully - default/procedural
+	 * 		 Resources?
+	 */
+	/*
+	 * TODO: The pack budget is only enforced by the per-frame sweep so a
+	 * 		 Scene load can still spike well past it. We could sweep on
+	 * 		 Release once the budget is exceeded and warn if referenced data
+	 * 		 Alone is close to it.
+	 */
+	result = aga_resource_new(pack, path, &res);
+	if(aga_script_err("aga_resource_new", result)) goto cleanup;
+
+	{
+		/* The image lives in the texture object from here on. */
+		asys_bool_t failed = agan_texture_upload(res, do_mips, path);
+
+		result = aga_resource_release(res);
+		if(aga_script_err("aga_resource_release", result)) goto cleanup;
+
+		if(failed) goto cleanup;
+	}
+
+	if(do_mips) {
+		min = tex_filter ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+	}
+	else min = mag;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min);
+	if(aga_script_gl_err("glTexParameteri")) goto cleanup;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag);
+	if(aga_script_gl_err("glTexParameteri")) goto cleanup;
+
+	*out = texture;
+
+	return ASYS_FALSE;
+
+	cleanup: {
+		asys_log_result(
+				__FILE__, "agan_texture_release",
+				agan_texture_release(texture));
+
+		return ASYS_TRUE;
+	}
+}
+
+/*
+ * TODO: Object models should be able to specify a billboard texture for auto
+ * 		 LOD -- especially when we have our zoning/distance culling system.
+ */
+static asys_bool_t agan_mkobj_model(
+		struct py_env* env, struct agan_object* obj,
+		struct aga_config_node* conf, struct aga_resource_pack* pack,
+		const char* objpath) {
+
+	static const char* model = "Model";
+	static const char* texture = "Texture";
+	static const char* filter = "Filter";
+	static const char* mipmap = "Mipmap";
+
+	struct aga_settings* settings = AGA_GET_USERDATA(env)->opts;
+
+	enum asys_result result;
+
+	struct aga_resource* res;
+	char* model_path;
+	char* texture_path;
+
+	asys_bool_t do_mips, tex_filter, failed;
+	aga_config_int_t v;
+
+	result = aga_config_lookup(
+			conf->children, &filter, 1, &v, AGA_INTEGER, ASYS_FALSE);
+	if(result) v = 1;
+	tex_filter = !!v;
+
+	result = aga_config_lookup(
+			conf->children, &mipmap, 1, &v, AGA_INTEGER, ASYS_FALSE);
+
+	if(result) v = settings->mipmap_default;
+	do_mips = !!v;
+
+	result = aga_config_lookup(
+			conf->children, &texture, 1, &texture_path, AGA_PATH, ASYS_FALSE);
+
+	if(result) {
+		/* TODO: Does this handle this case gracefully. */
+		asys_log(
+				__FILE__, "warn: Object `%s' is missing a texture entry",
+				objpath);
+	}
+	else {
+		failed = agan_texture_new(
+				pack, texture_path, do_mips, tex_filter, &obj->texture);
+
+		asys_memory_free(texture_path);
+		if(failed) return ASYS_TRUE;
+	}
+
+	result = aga_config_lookup(
+			conf->children, &model, 1, &model_path, AGA_PATH, ASYS_FALSE);
+
+	if(result) {
+		asys_log(
+				__FILE__, "warn: Object `%s' is missing a model entry",
+				objpath);
+	}
+	else {
+		aga_config_int_t ver;
+
+		asys_memory_free(obj->modelpath);
+		if(!(obj->modelpath = asys_string_duplicate(model_path))) {
+			asys_memory_free(model_path);
+			py_error_set_nomem();
+			return ASYS_TRUE;
+		}
+
+		result = aga_resource_pack_lookup(pack, model_path, &res);
+		if(aga_script_err("aga_resource_pack_lookup", result)) {
+			asys_log(
+					__FILE__, "err: Failed to find resource `%s'", model_path);
+
+			asys_memory_free(model_path);
+			return ASYS_TRUE;
+		}
+
+		agan_mkobj_extent(obj, res);
+
+		/* Unversioned models predate versioning altogether. */
+		ver = res->version ? res->version : 1;
+
+		if(ver == 1) {
+			AGA_DEPRECATED_IMPL("Loading Version 1 model data is deprecated");
+		}
+
+		failed = agan_model_new(pack, model_path, ver, &obj->model);
+
+		asys_memory_free(model_path);
+		if(failed) return ASYS_TRUE;
+	}
 
 	return ASYS_FALSE;
 }
@@ -370,13 +1141,11 @@ static asys_bool_t agan_mkobj_light(
 
 	static const char* light = "Light";
 
-	enum asys_result result;
-
 	struct aga_config_node* node = conf->children;
 	struct agan_lightdata* data;
 
 	aga_config_int_t scr;
-	asys_size_t i, j;
+	asys_size_t i;
 
 	double v;
 
@@ -417,73 +1186,33 @@ static asys_bool_t agan_mkobj_light(
 			data->angle = (float) v;
 		}
 		else if(asys_string_equal("Direction", child->name)) {
-			for(j = 0; j < 3; ++j) {
-				const char* comp = agan_xyz[j];
-				float (*dir)[3] = &data->direction;
-
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, ASYS_FALSE);
-				(*dir)[j] = result ? 0.0f : (float) v;
-			}
+			agan_conf_floats(child, agan_xyz, 3, data->direction, 0.0f);
 		}
-
-		/* TODO: General API for getting multiple components from conf node. */
 		else if(asys_string_equal("Ambient", child->name)) {
-			float (*col)[4] = &data->ambient;
-
-			for(j = 0; j < 3; ++j) {
-				const char* comp = agan_rgb[j];
-
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, ASYS_FALSE);
-				if(result) (*col)[j] = 1.0f;
-				else (*col)[j] = (float) v;
-			}
-
-			(*col)[3] = 1.0f;
+			agan_conf_floats(child, agan_rgb, 3, data->ambient, 1.0f);
+			data->ambient[3] = 1.0f;
 		}
 		else if(asys_string_equal("Diffuse", child->name)) {
-			float (*col)[4] = &data->diffuse;
-
-			for(j = 0; j < 3; ++j) {
-				const char* comp = agan_rgb[j];
-
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, ASYS_FALSE);
-				(*col)[j] = result ? 1.0f : (float) v;
-			}
-
-			(*col)[3] = 1.0f;
+			agan_conf_floats(child, agan_rgb, 3, data->diffuse, 1.0f);
+			data->diffuse[3] = 1.0f;
 		}
 		else if(asys_string_equal("Specular", child->name)) {
-			float (*col)[4] = &data->specular;
-
-			for(j = 0; j < 3; ++j) {
-				const char* comp = agan_rgb[j];
-
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, ASYS_FALSE);
-				(*col)[j] = result ? 1.0f : (float) v;
-			}
-
-			(*col)[3] = 1.0f;
+			agan_conf_floats(child, agan_rgb, 3, data->specular, 1.0f);
+			data->specular[3] = 1.0f;
 		}
 		else if(asys_string_equal("Attenuation", child->name)) {
 			static const char* attenuation[] = {
 					"Constant", "Linear", "Quadratic"
 			};
 
-			float* at[ASYS_LENGTH(attenuation)];
-			at[0] = &data->constant_attenuation;
-			at[1] = &data->linear_attenuation;
-			at[2] = &data->quadratic_attenuation;
-			for(j = 0; j < ASYS_LENGTH(at); ++j) {
-				const char* comp = attenuation[j];
+			float at[ASYS_LENGTH(attenuation)];
 
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, ASYS_FALSE);
-				*at[j] = result ? 0.0f : (float) v;
-			}
+			agan_conf_floats(
+					child, attenuation, ASYS_LENGTH(attenuation), at, 0.0f);
+
+			data->constant_attenuation = at[0];
+			data->linear_attenuation = at[1];
+			data->quadratic_attenuation = at[2];
 		}
 	}
 
@@ -524,21 +1253,12 @@ struct py_object* agan_mkobj(
 	enum asys_result result;
 
 	struct agan_object* obj;
-	struct py_int* v;
 	struct py_object* retval;
 	struct aga_config_node conf = { 0 };
 
-	struct asys_stream* stream;
-
 	const char* path;
 	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
 
-	/*
-	 * TODO: This is horrible (but only exists until we have an object registry
-	 * 		 To get small unique handle IDs for colour picking.
-	 */
-	static asys_uint_t objn = 0;
-
 	(void) env;
 	(void) self;
 
@@ -548,27 +1268,19 @@ struct py_object* agan_mkobj(
 		return aga_arg_error("mkobj", "string");
 	}
 
-	if(!(obj = asys_memory_allocate_zero(1, sizeof(struct agan_object)))) {
-		return py_error_set_nomem();
-	}
-
-	retval = aga_script_pointer_new(obj);
-	v = (struct py_int*) retval;
+	result = agan_object_new(&obj);
+	if(aga_script_err("agan_object_new", result)) return 0;
 
-	obj->ind = objn++;
-	obj->light_data = 0;
 	if(!(obj->transform = agan_mktrans(env, 0, 0))) goto cleanup;
 
 	path = py_string_get(args);
 
-	result = aga_resource_pack_lookup(pack, path, &obj->res);
-	if(aga_script_err("aga_resource_pack_lookup", result)) goto cleanup;
-
-	result = aga_resource_seek(obj->res, &stream);
-	if(aga_script_err("aga_resource_seek", result)) goto cleanup;
+	/* Objects hold onto their config so it can be viewed in-place. */
+	result = aga_resource_new(pack, path, &obj->res);
+	if(aga_script_err("aga_resource_new", result)) goto cleanup;
 
-	result = aga_config_new(stream, obj->res->size, &conf);
-	if(aga_script_err("aga_resource_stream", result)) goto cleanup;
+	result = agan_getobjconf(obj, &conf);
+	if(aga_script_err("agan_getobjconf", result)) goto cleanup;
 
 	if(agan_mkobj_trans(obj, &conf)) goto cleanup;
 	if(agan_mkobj_model(env, obj, &conf, pack, path)) goto cleanup;
@@ -577,21 +1289,38 @@ struct py_object* agan_mkobj(
 	result = aga_config_delete(&conf);
 	if(aga_script_err("aga_config_delete", result)) goto cleanup;
 
+	if(!(retval = py_int_new((py_value_t) obj->handle))) goto cleanup;
+
 	apro_stamp_end(APRO_SCRIPTGLUE_MKOBJ);
 
-	return (struct py_object*) retval;
+	return retval;
 
 	cleanup: {
 		asys_log_result(
 					__FILE__, "aga_config_delete", aga_config_delete(&conf));
 
-		glDeleteLists(obj->drawlist, 1);
-		(void) aga_error_gl(__FILE__, "glDeleteLists");
+		if(obj->model) {
+			asys_log_result(
+					__FILE__, "agan_model_release",
+					agan_model_release(obj->model));
+		}
+
+		if(obj->texture) {
+			asys_log_result(
+					__FILE__, "agan_texture_release",
+					agan_texture_release(obj->texture));
+		}
+
+		if(obj->res) {
+			asys_log_result(
+					__FILE__, "aga_resource_release",
+					aga_resource_release(obj->res));
+		}
 
 		asys_memory_free(obj->light_data);
+		asys_memory_free(obj->modelpath);
 		py_object_decref(obj->transform);
-		asys_memory_free(aga_script_pointer_get(v));
-		py_object_decref(retval);
+		agan_object_free(obj);
 
 		return 0;
 	}
@@ -600,7 +1329,10 @@ struct py_object* agan_mkobj(
 struct py_object* agan_killobj(
 		struct py_env* env, struct py_object* self, struct py_object* args) {
 
+	enum asys_result result;
+
 	struct agan_object* obj;
+	asys_bool_t failed = ASYS_FALSE;
 
 	(void) env;
 	(void) self;
@@ -611,15 +1343,31 @@ struct py_object* agan_killobj(
 		return aga_arg_error("killobj", "int");
 	}
 
-	obj = aga_script_pointer_get(args);
+	if(!(obj = agan_object_arg(args))) return 0;
 
-	glDeleteLists(obj->drawlist, 1);
-	if(aga_script_gl_err("glDeleteLists")) return 0;
+	/*
+	 * Releases drop their reference even where they fail, so the object is
+	 * Always torn down and its handle retired before any error is raised.
+	 */
+	if(obj->model) {
+		result = agan_model_release(obj->model);
+		if(aga_script_err("agan_model_release", result)) failed = ASYS_TRUE;
+	}
 
-	py_object_decref(obj->transform);
+	if(obj->texture) {
+		result = agan_texture_release(obj->texture);
+		if(aga_script_err("agan_texture_release", result)) failed = ASYS_TRUE;
+	}
 
+	result = aga_resource_release(obj->res);
+	if(aga_script_err("aga_resource_release", result)) failed = ASYS_TRUE;
+
+	asys_memory_free(obj->light_data);
 	asys_memory_free(obj->modelpath);
-	asys_memory_free(obj);
+	py_object_decref(obj->transform);
+	agan_object_free(obj);
+
+	if(failed) return 0;
 
 	apro_stamp_end(APRO_SCRIPTGLUE_KILLOBJ);
 
@@ -679,7 +1427,7 @@ struct py_object* agan_inobj(
 
 	planar = !!py_int_get(planarp);
 
-	obj = aga_script_pointer_get(objp);
+	if(!(obj = agan_object_arg(objp))) return 0;
 	memcpy(min, obj->min_extent, sizeof(min));
 	memcpy(max, obj->max_extent, sizeof(max));
 
@@ -772,23 +1520,14 @@ struct py_object* agan_inobj(
 }
 
 /*
- * TODO: Avoid reloading conf for every call. We shouldn't permanently cache
- * 		 The config tree but it would be wise to selectively hold it for a
- * 		 Load/save period.
+ * Object configs are compiled at build time and the object holds a reference
+ * To its resource, so this only needs to lay out the nodes -- names and
+ * Strings are viewed in-place.
  */
 enum asys_result agan_getobjconf(
 		struct agan_object* obj, struct aga_config_node* node) {
 
-	struct asys_stream* stream;
-	enum asys_result result;
-
-	result = aga_resource_seek(obj->res, &stream);
-	if(aga_script_err("aga_resource_seek", result)) return 0;
-
-	result = aga_config_new(stream, obj->res->size, node);
-	if(aga_script_err("aga_config_new", result)) return 0;
-
-	return ASYS_RESULT_OK;
+	return aga_config_view(obj->res->data, obj->res->size, node);
 }
 
 struct py_object* agan_objconf(
@@ -815,7 +1554,7 @@ struct py_object* agan_objconf(
 		return aga_arg_error("objconf", "int and list");
 	}
 
-	obj = aga_script_pointer_get(o);
+	if(!(obj = agan_object_arg(o))) return 0;
 
 	result = agan_getobjconf(obj, &conf);
 	if(aga_script_err("agan_getobjconf", result)) return 0;
@@ -871,6 +1610,24 @@ static asys_bool_t agan_putobj_light(struct agan_lightdata* data) {
 	return ASYS_FALSE;
 }
 
+static asys_bool_t agan_putobj_model(const struct agan_object* obj) {
+	/* Unbinding leaves objects without a texture untextured. */
+	glBindTexture(GL_TEXTURE_2D, obj->texture ? obj->texture->name : 0);
+	if(aga_script_gl_err("glBindTexture")) return ASYS_TRUE;
+
+	if(!obj->model) return ASYS_FALSE;
+
+	/* Models from v2.1.0 and below respected model vertex colouration. */
+	if(!obj->model->coloured) {
+		asys_uchar_t r = (obj->ind >> (2 * 8)) & 0xFF;
+		asys_uchar_t g = (obj->ind >> (1 * 8)) & 0xFF;
+		asys_uchar_t b = (obj->ind >> (0 * 8)) & 0xFF;
+		glColor3ub(r, g, b);
+	}
+
+	return agan_model_draw(obj->model);
+}
+
 struct py_object* agan_putobj(
 		struct py_env* env, struct py_object* self, struct py_object* args) {
 
@@ -887,7 +1644,7 @@ struct py_object* agan_putobj(
 		return aga_arg_error("putobj", "int");
 	}
 
-	obj = aga_script_pointer_get(args);
+	if(!(obj = agan_object_arg(args))) return 0;
 
 	glMatrixMode(GL_MODELVIEW);
 	if(aga_script_gl_err("glMatrixMode")) return 0;
@@ -905,8 +1662,7 @@ struct py_object* agan_putobj(
 
 	apro_stamp_start(APRO_PUTOBJ_CALL);
 
-	glCallList(obj->drawlist);
-	if(aga_script_gl_err("glCallList")) return 0;
+	if(agan_putobj_model(obj)) return 0;
 
 	apro_stamp_end(APRO_PUTOBJ_CALL);
 
@@ -938,7 +1694,7 @@ struct py_object* agan_objtrans(
 		return aga_arg_error("objtrans", "int");
 	}
 
-	obj = aga_script_pointer_get(args);
+	if(!(obj = agan_object_arg(args))) return 0;
 
 	apro_stamp_end(APRO_SCRIPTGLUE_OBJTRANS);
 
@@ -959,7 +1715,7 @@ struct py_object* agan_objind(
 		return aga_arg_error("agan_objind", "int");
 	}
 
-	obj = aga_script_pointer_get(args);
+	if(!(obj = agan_object_arg(args))) return 0;
 
 	apro_stamp_end(APRO_SCRIPTGLUE_OBJTRANS);
 
@@ -95,7 +95,7 @@ struct py_object* agan_packlist(
 	for(i = 0; i < pack->count; ++i) {
 		struct py_object* string;
 
-		string = py_string_new(pack->resources[i].config->name);
+		string = py_string_new(pack->resources[i].name);
 		if(!string) {
 			py_error_set_nomem();
 			goto cleanup;
@@ -117,6 +117,55 @@ struct py_object* agan_packlist(
 	}
 }
 
+struct py_object* agan_prefetch(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+
+	enum asys_result result;
+	asys_size_t i;
+
+	(void) env;
+	(void) self;
+
+	/* prefetch(list[string...]) */
+	if(!aga_arg_list(args, PY_TYPE_LIST)) {
+		return aga_arg_error("prefetch", "list");
+	}
+
+	for(i = 0; i < py_varobject_size(args); ++i) {
+		struct py_object* path = py_list_get(args, i);
+
+		if(path->type != PY_TYPE_STRING) {
+			return aga_arg_error("prefetch", "list[string...]");
+		}
+
+		result = aga_resource_prefetch(pack, py_string_get(path));
+		if(aga_script_err("aga_resource_prefetch", result)) return 0;
+	}
+
+	return py_object_incref(PY_NONE);
+}
+
+struct py_object* agan_prefetching(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+
+	enum asys_result result;
+	asys_size_t pending;
+
+	(void) env;
+	(void) self;
+
+	if(args) return aga_arg_error("prefetching", "none");
+
+	result = aga_resource_pack_pending(pack, &pending);
+	if(aga_script_err("aga_resource_pack_pending", result)) return 0;
+
+	return py_int_new((py_value_t) pending);
+}
+
 static enum asys_result agan_log_object(
 		struct py_object* op, asys_fixed_buffer_t* buffer, asys_bool_t top) {
 